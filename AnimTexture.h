@@ -0,0 +1,232 @@
+#pragma once
+#include <vector>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "mat3x4.h"
+#include "Clip.h"
+#include "Skeleton.h"
+
+// IEEE 754 binary16, rounded to nearest even; overflow becomes infinity.
+inline uint16_t floatToHalf( float f )
+{
+	uint32_t x;
+	memcpy( &x,&f,sizeof( x ) );
+	uint32_t sign = (x >> 16) & 0x8000;
+	uint32_t mag = x & 0x7FFFFFFF;
+	if ( mag >= 0x7F800000 )
+	{
+		return (uint16_t)(sign | (mag > 0x7F800000 ? 0x7E00 : 0x7C00));
+	}
+	if ( mag >= 0x477FF000 ) // 65520, the first value that rounds past the largest half
+	{
+		return (uint16_t)(sign | 0x7C00);
+	}
+	if ( mag < 0x38800000 ) // below the smallest normal half, 2^-14
+	{
+		float a;
+		memcpy( &a,&mag,sizeof( a ) );
+		return (uint16_t)(sign | (uint32_t)lrintf( a * 16777216.0f ));
+	}
+	uint32_t r = mag - 0x38000000;
+	r += 0xFFF + ((r >> 13) & 1);
+	return (uint16_t)(sign | (r >> 13));
+}
+
+inline float halfToFloat( uint16_t h )
+{
+	uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+	uint32_t exponent = (h >> 10) & 0x1F;
+	uint32_t mantissa = h & 0x3FF;
+	uint32_t bits;
+	if ( exponent == 0 )
+	{
+		float f = float( mantissa ) * (1.0f / 16777216.0f);
+		return sign ? -f : f;
+	}
+	if ( exponent == 31 )
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	float f;
+	memcpy( &f,&bits,sizeof( f ) );
+	return f;
+}
+
+enum class AnimTextureFormat
+{
+	Float32, // GL_RGBA32F, GL_FLOAT
+	Float16  // GL_RGBA16F, GL_HALF_FLOAT
+};
+
+// A clip baked into skinning palettes for texture upload: one row per frame,
+// three RGBA texels per joint holding that joint's mat3x4 rows, so texel
+// ( joint * 3 + r, frame ) is row r of the joint's palette matrix. Rows are
+// tightly packed (GetRowPitch() bytes, a multiple of 8 in both formats).
+class AnimTexture
+{
+protected:
+	std::vector<float> mFloats;
+	std::vector<uint16_t> mHalves;
+	AnimTextureFormat mFormat;
+	unsigned int mJoints;
+	unsigned int mFrames;
+	float mSampleRate;
+	float mStartTime;
+	float mEndTime;
+	bool mLooping;
+
+	float Texel( size_t index ) const
+	{
+		return mFormat == AnimTextureFormat::Float32 ? mFloats[index] : halfToFloat( mHalves[index] );
+	}
+public:
+	AnimTexture()
+		:
+		mFormat( AnimTextureFormat::Float32 ),
+		mJoints( 0 ),
+		mFrames( 0 ),
+		mSampleRate( 0.0f ),
+		mStartTime( 0.0f ),
+		mEndTime( 0.0f ),
+		mLooping( true )
+	{}
+
+	void Resize( unsigned int joints,unsigned int frames,AnimTextureFormat format )
+	{
+		mJoints = joints;
+		mFrames = frames;
+		mFormat = format;
+		size_t size = (size_t)joints * frames * 12;
+		mFloats.assign( format == AnimTextureFormat::Float32 ? size : 0,0.0f );
+		mHalves.assign( format == AnimTextureFormat::Float16 ? size : 0,0 );
+	}
+
+	// Time mapping: frame i holds the clip at start + i / rate.
+	void SetTiming( float sampleRate,float startTime,float endTime,bool looping )
+	{
+		mSampleRate = sampleRate;
+		mStartTime = startTime;
+		mEndTime = endTime;
+		mLooping = looping;
+	}
+
+	AnimTextureFormat GetFormat() const { return mFormat; }
+	unsigned int GetJointCount() const { return mJoints; }
+	unsigned int GetFrameCount() const { return mFrames; }
+	float GetSampleRate() const { return mSampleRate; }
+	unsigned int GetWidth() const { return mJoints * 3; }
+	unsigned int GetHeight() const { return mFrames; }
+	size_t GetTexelSize() const { return mFormat == AnimTextureFormat::Float32 ? 16 : 8; }
+	size_t GetRowPitch() const { return GetWidth() * GetTexelSize(); }
+	size_t GetSizeInBytes() const { return GetRowPitch() * mFrames; }
+	const void* GetData() const
+	{
+		return mFormat == AnimTextureFormat::Float32 ? (const void*)mFloats.data() : (const void*)mHalves.data();
+	}
+
+	void SetPalette( unsigned int frame,const mat3x4 *palette )
+	{
+		size_t base = (size_t)frame * mJoints * 12;
+		if ( mFormat == AnimTextureFormat::Float32 )
+		{
+			memcpy( mFloats.data() + base,palette,sizeof( mat3x4 ) * mJoints );
+			return;
+		}
+		for ( unsigned int j = 0; j < mJoints; ++j )
+		{
+			for ( int k = 0; k < 12; ++k )
+			{
+				mHalves[base + j * 12 + k] = floatToHalf( palette[j].v[k] );
+			}
+		}
+	}
+
+	mat3x4 GetMatrix( unsigned int frame,unsigned int joint ) const
+	{
+		mat3x4 result;
+		size_t base = ((size_t)frame * mJoints + joint) * 12;
+		for ( int k = 0; k < 12; ++k )
+		{
+			result.v[k] = Texel( base + k );
+		}
+		return result;
+	}
+
+	void GetPalette( unsigned int frame,mat3x4 *out ) const
+	{
+		for ( unsigned int j = 0; j < mJoints; ++j )
+		{
+			out[j] = GetMatrix( frame,j );
+		}
+	}
+
+	// Fractional frame for a clip time, wrapped or clamped like the clip.
+	float GetFrame( float time ) const
+	{
+		float duration = mEndTime - mStartTime;
+		if ( duration <= 0.0f || mFrames <= 1 )
+		{
+			return 0.0f;
+		}
+		if ( mLooping )
+		{
+			time = fmodf( time - mStartTime,duration );
+			time = (time < 0.0f ? time + duration : time) + mStartTime;
+		}
+		time = time < mStartTime ? mStartTime : (time > mEndTime ? mEndTime : time);
+		float frame = (time - mStartTime) * mSampleRate;
+		float last = float( mFrames - 1 );
+		return frame > last ? last : frame;
+	}
+
+	// What a shader sampling with linear filtering along the frame axis
+	// reads: the two nearest frames' rows blended per component.
+	void Sample( float time,mat3x4 *out ) const
+	{
+		float frame = GetFrame( time );
+		unsigned int f0 = (unsigned int)frame;
+		unsigned int f1 = f0 + 1 < mFrames ? f0 + 1 : f0;
+		float t = frame - float( f0 );
+		for ( unsigned int j = 0; j < mJoints; ++j )
+		{
+			mat3x4 a = GetMatrix( f0,j );
+			mat3x4 b = GetMatrix( f1,j );
+			for ( int k = 0; k < 12; ++k )
+			{
+				out[j].v[k] = a.v[k] + (b.v[k] - a.v[k]) * t;
+			}
+		}
+	}
+};
+
+// Samples clip at evenly spaced frames from its start through its end, at
+// least sampleRate per second, and stores each frame's skinning palette.
+// The last frame holds the end pose even when the clip loops.
+template<typename CLIP>
+void bakeAnimTexture( const Skeleton &skeleton,const CLIP &clip,float sampleRate,
+	AnimTextureFormat format,AnimTexture &out )
+{
+	unsigned int joints = skeleton.GetRestPose().Size();
+	float duration = clip.GetDuration();
+	unsigned int frames = duration > 0.0f && sampleRate > 0.0f ? (unsigned int)ceilf( duration * sampleRate ) + 1 : 1;
+	// Round the rate up so the last frame lands exactly on the end.
+	float rate = frames > 1 ? float( frames - 1 ) / duration : 0.0f;
+	out.Resize( joints,frames,format );
+	out.SetTiming( rate,clip.GetStartTime(),clip.GetEndTime(),clip.GetLooping() );
+	float last = clipLastSampleTime( clip );
+	Pose pose;
+	std::vector<mat3x4> palette( joints );
+	for ( unsigned int i = 0; i < frames; ++i )
+	{
+		float time = i + 1 < frames ? clip.GetStartTime() + float( i ) / rate : last;
+		pose = skeleton.GetRestPose();
+		clip.Sample( pose,time );
+		skeleton.GetMatrixPalette( pose,palette.data() );
+		out.SetPalette( i,palette.data() );
+	}
+}
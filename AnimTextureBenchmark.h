@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include "Benchmark.h"
+#include "CrowdBenchmark.h"
+#include "AnimTexture.h"
+
+// Baked palette textures against live sampling: memory for the keys and for
+// each texture format, lookup error, and palettes per second.
+
+template<typename CLIP>
+size_t clipKeyBytes( const CLIP &clip )
+{
+	size_t bytes = 0;
+	for ( unsigned int i = 0, size = clip.Size(); i < size; ++i )
+	{
+		const auto &track = clip.GetTrackAtIndex( i );
+		bytes += track.GetPositionTrack().Size() * sizeof( Frame<3> );
+		bytes += track.GetRotationTrack().Size() * sizeof( Frame<4> );
+		bytes += track.GetScaleTrack().Size() * sizeof( Frame<3> );
+	}
+	return bytes;
+}
+
+// Largest component difference between two palettes.
+inline float paletteError( const mat3x4 *a,const mat3x4 *b,unsigned int joints )
+{
+	float error = 0.0f;
+	for ( unsigned int j = 0; j < joints; ++j )
+	{
+		for ( int k = 0; k < 12; ++k )
+		{
+			float d = fabsf( a[j].v[k] - b[j].v[k] );
+			error = d > error ? d : error;
+		}
+	}
+	return error;
+}
+
+inline void benchmarkAnimTexture( unsigned int joints = 60,float duration = 2.0f,float bakeRate = 30.0f,unsigned int lookups = 20000 )
+{
+	srand( 77 );
+	// A shallow tree like a character's rather than one long chain, so the
+	// filtering error reads like it would on a real rig.
+	Pose rest;
+	fillBenchmarkPose( rest,joints );
+	for ( unsigned int i = 1; i < joints; ++i )
+	{
+		rest.SetParent( i,(int)(i - 1) / 4 );
+	}
+	Skeleton skeleton( rest,rest,std::vector<std::string>( joints,"joint" ) );
+	Clip clip;
+	fillBenchmarkClip( clip,joints,duration,30.0f );
+	AnimTexture full,half;
+	bakeAnimTexture( skeleton,clip,bakeRate,AnimTextureFormat::Float32,full );
+	bakeAnimTexture( skeleton,clip,bakeRate,AnimTextureFormat::Float16,half );
+	std::cout << "clip keys: " << clipKeyBytes( clip ) << " bytes\n";
+	std::cout << "texture " << full.GetWidth() << "x" << full.GetHeight() << " rgba32f: " << full.GetSizeInBytes() << " bytes\n";
+	std::cout << "texture " << half.GetWidth() << "x" << half.GetHeight() << " rgba16f: " << half.GetSizeInBytes() << " bytes\n";
+
+	// Error between baked frames (filtering) and from the half encoding.
+	std::vector<mat3x4> live( joints ),baked( joints ),halfBaked( joints );
+	Pose pose;
+	float filterError = 0.0f;
+	float halfError = 0.0f;
+	for ( unsigned int i = 0; i < 200; ++i )
+	{
+		float time = duration * float( i ) / 200.0f;
+		pose = skeleton.GetRestPose();
+		clip.Sample( pose,time );
+		skeleton.GetMatrixPalette( pose,live.data() );
+		full.Sample( time,baked.data() );
+		half.Sample( time,halfBaked.data() );
+		float e = paletteError( live.data(),baked.data(),joints );
+		filterError = e > filterError ? e : filterError;
+		e = paletteError( baked.data(),halfBaked.data(),joints );
+		halfError = e > halfError ? e : halfError;
+	}
+	std::cout << "max error, filtered lookup vs live: " << filterError << ", half vs float: " << halfError << "\n";
+
+	BenchmarkResult r = runBenchmark( "sample + palette",lookups,[&]()
+	{
+		for ( unsigned int i = 0; i < lookups; ++i )
+		{
+			pose = skeleton.GetRestPose();
+			clip.Sample( pose,float( i ) * 0.0123f );
+			skeleton.GetMatrixPalette( pose,live.data() );
+		}
+		benchmarkSink() = live[joints / 2].v[3];
+	} );
+	printBenchmark( r,"palettes" );
+	r = runBenchmark( "baked lookup rgba32f",lookups,[&]()
+	{
+		for ( unsigned int i = 0; i < lookups; ++i )
+		{
+			full.Sample( float( i ) * 0.0123f,baked.data() );
+		}
+		benchmarkSink() = baked[joints / 2].v[3];
+	} );
+	printBenchmark( r,"palettes" );
+	r = runBenchmark( "baked lookup rgba16f",lookups,[&]()
+	{
+		for ( unsigned int i = 0; i < lookups; ++i )
+		{
+			half.Sample( float( i ) * 0.0123f,halfBaked.data() );
+		}
+		benchmarkSink() = halfBaked[joints / 2].v[3];
+	} );
+	printBenchmark( r,"palettes" );
+}
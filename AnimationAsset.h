@@ -0,0 +1,718 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "Skeleton.h"
+#include "ClassifiedClip.h"
+#include "MappedFile.h"
+
+// Relocatable binary file holding a skeleton and its clips, laid out so the
+// bytes on disk are the structures used at runtime: every reference is a
+// signed offset from the field holding it, so a file works wherever it is
+// mapped, with nothing to parse, fix up or copy. Load is map + validate.
+// Channels are stored classified (see ClassifiedClip.h): default ones are
+// dropped, constant ones keep one value, animated ones keep their keys as
+// the per segment polynomials of PolynomialTrack.h, sampled in place.
+// All fields are 4 byte, little-endian; version bumps on any layout change.
+#define ANIMATION_ASSET_MAGIC 0x4D494E41u // "ANIM"
+#define ANIMATION_ASSET_VERSION 1u
+
+// Offset from this field to the target in bytes, 0 for none. Only valid in
+// place: a copy out of the file points somewhere else.
+template<typename T>
+struct AssetPtr
+{
+	int32_t offset;
+	const T* Get() const { return offset ? (const T*)((const char*)this + offset) : nullptr; }
+};
+
+template<typename T>
+struct AssetArray
+{
+	AssetPtr<T> data;
+	uint32_t count;
+	unsigned int Size() const { return count; }
+	const T* Data() const { return data.Get(); }
+	const T& operator[]( unsigned int index ) const { return data.Get()[index]; }
+};
+
+// Null terminated; count includes the terminator.
+struct AssetString
+{
+	AssetArray<char> chars;
+	const char* CStr() const { return chars.count ? chars.Data() : ""; }
+};
+
+struct AssetTransform
+{
+	float position[3];
+	float rotation[4];
+	float scale[3];
+	Transform Get() const
+	{
+		return Transform( vec3( position ),quat( rotation[0],rotation[1],rotation[2],rotation[3] ),vec3( scale ) );
+	}
+};
+
+struct AssetSkeleton
+{
+	AssetArray<int16_t> parents;
+	AssetArray<AssetTransform> restPose;
+	AssetArray<AssetTransform> bindPose;
+	AssetArray<mat3x4> invBindPose;
+	AssetArray<AssetString> names;
+
+	unsigned int Size() const { return parents.count; }
+
+	// Per instance poses are the only copy; resizes out to Size().
+	void GetPose( const AssetArray<AssetTransform> &transforms,Pose &out ) const
+	{
+		unsigned int size = Size();
+		out.Resize( size );
+		for ( unsigned int i = 0; i < size; ++i )
+		{
+			out.SetParent( i,parents[i] );
+			out.SetLocalTransform( i,transforms[i].Get() );
+		}
+	}
+	void GetRestPose( Pose &out ) const { GetPose( restPose,out ); }
+	void GetBindPose( Pose &out ) const { GetPose( bindPose,out ); }
+
+	// For code that wants a Skeleton; the palettes below need none.
+	Skeleton ToSkeleton() const
+	{
+		Pose rest,bind;
+		GetRestPose( rest );
+		GetBindPose( bind );
+		std::vector<std::string> jointNames( Size() );
+		for ( unsigned int i = 0; i < Size(); ++i )
+		{
+			jointNames[i] = names[i].CStr();
+		}
+		return Skeleton( rest,bind,jointNames );
+	}
+
+	int FindJoint( const char *name ) const
+	{
+		for ( unsigned int i = 0, size = Size(); i < size; ++i )
+		{
+			if ( strcmp( names[i].CStr(),name ) == 0 )
+			{
+				return (int)i;
+			}
+		}
+		return -1;
+	}
+
+	// Skeleton::GetMatrixPalette with the inverse bind read from the file.
+	void GetMatrixPalette( const Pose &pose,mat3x4 *out ) const
+	{
+		unsigned int size = Size();
+		const int16_t *p = pose.GetParents();
+		const Transform *local = pose.GetLocalTransforms();
+		for ( unsigned int i = 0; i < size; ++i )
+		{
+			mat3x4 m( transformToMat4( local[i] ).m );
+			out[i] = p[i] < 0 ? m : out[p[i]] * m;
+		}
+		const mat3x4 *invBind = invBindPose.Data();
+		for ( unsigned int i = 0; i < size; ++i )
+		{
+			out[i] = out[i] * invBind[i];
+		}
+	}
+};
+
+// Constant: values holds the one value. Animated: keyCount times and
+// keyCount * 4 * N polynomial coefficients, last key's segment included.
+struct AssetChannel
+{
+	uint8_t channelClass; // ChannelClass
+	uint8_t components;
+	uint16_t reserved;
+	uint32_t keyCount;
+	AssetPtr<float> times;
+	AssetPtr<float> values;
+};
+
+template<typename T,int N>
+void sampleAssetChannel( const AssetChannel &channel,float time,bool looping,T &out )
+{
+	if ( channel.channelClass == (uint8_t)ChannelClass::Constant )
+	{
+		out = TTrackValue<T>::raw( channel.values.Get() );
+	}
+	else if ( channel.channelClass == (uint8_t)ChannelClass::Animated )
+	{
+		const float *times = channel.times.Get();
+		float t = polynomialAdjustTime( times,channel.keyCount,time,looping );
+		float result[N];
+		polynomialEvaluate<N>( channel.values.Get(),times,polynomialSegmentIndex( times,channel.keyCount,t ),t,result );
+		out = TTrackValue<T>::cast( result );
+	}
+}
+
+struct AssetTrack
+{
+	uint32_t joint;
+	AssetChannel position;
+	AssetChannel rotation;
+	AssetChannel scale;
+};
+
+struct AssetClip
+{
+	AssetString name;
+	float startTime;
+	float endTime;
+	uint32_t looping;
+	AssetArray<AssetTrack> tracks;
+
+	float GetDuration() const { return endTime - startTime; }
+
+	float AdjustTimeToFitRange( float time ) const
+	{
+		float duration = endTime - startTime;
+		if ( duration <= 0.0f )
+		{
+			return startTime;
+		}
+		if ( looping )
+		{
+			time = fmodf( time - startTime,duration );
+			if ( time < 0.0f )
+			{
+				time += duration;
+			}
+			return time + startTime;
+		}
+		return time < startTime ? startTime : (time > endTime ? endTime : time);
+	}
+
+	// Same result as ClassifiedClip::Sample: out must hold the rest pose for
+	// the default channels, which are not stored.
+	float Sample( Pose &out,float time ) const
+	{
+		// Like Clip, a clip without duration leaves its animated channels alone.
+		bool animated = GetDuration() != 0.0f;
+		time = animated ? AdjustTimeToFitRange( time ) : 0.0f;
+		bool loop = looping != 0;
+		const uint8_t skip = animated ? 0xFF : (uint8_t)ChannelClass::Animated;
+		Transform *local = out.GetLocalTransforms();
+		const AssetTrack *track = tracks.Data();
+		for ( unsigned int i = 0, size = tracks.count; i < size; ++i )
+		{
+			Transform &t = local[track[i].joint];
+			if ( track[i].position.channelClass != skip )
+			{
+				sampleAssetChannel<vec3,3>( track[i].position,time,loop,t.position );
+			}
+			if ( track[i].rotation.channelClass != skip )
+			{
+				sampleAssetChannel<quat,4>( track[i].rotation,time,loop,t.rotation );
+			}
+			if ( track[i].scale.channelClass != skip )
+			{
+				sampleAssetChannel<vec3,3>( track[i].scale,time,loop,t.scale );
+			}
+		}
+		return time;
+	}
+
+	const char* GetName() const { return name.CStr(); }
+	float GetStartTime() const { return startTime; }
+	float GetEndTime() const { return endTime; }
+	bool GetLooping() const { return looping != 0; }
+};
+
+struct AssetHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size; // whole file in bytes
+	uint32_t reserved;
+	AssetPtr<AssetSkeleton> skeleton;
+	AssetArray<AssetClip> clips;
+};
+
+// The layout is the file format: these must not change without a version bump.
+static_assert( sizeof( AssetTransform ) == 40,"AssetTransform layout" );
+static_assert( sizeof( mat3x4 ) == 48,"mat3x4 layout" );
+static_assert( sizeof( AssetSkeleton ) == 40,"AssetSkeleton layout" );
+static_assert( sizeof( AssetChannel ) == 16,"AssetChannel layout" );
+static_assert( sizeof( AssetTrack ) == 52,"AssetTrack layout" );
+static_assert( sizeof( AssetClip ) == 28,"AssetClip layout" );
+static_assert( sizeof( AssetHeader ) == 28,"AssetHeader layout" );
+
+// Checks a buffer before anything reads it as an asset: header, that every
+// offset and count stays inside the buffer and is aligned, and what sampling
+// relies on (parents before children, joints in range, times sorted). Data
+// that passes cannot make the runtime read out of bounds.
+class AnimationAssetValidator
+{
+protected:
+	const char *mBase;
+	size_t mSize;
+	const char *mError;
+
+	bool Fail( const char *error )
+	{
+		mError = error;
+		return false;
+	}
+
+	// field must already be known to lie inside the buffer.
+	template<typename T>
+	const T* Resolve( const AssetPtr<T> &field,uint32_t count,size_t align = alignof( T ) )
+	{
+		if ( count == 0 )
+		{
+			return nullptr;
+		}
+		int64_t target = (int64_t)((const char*)&field - mBase) + field.offset;
+		uint64_t bytes = (uint64_t)count * sizeof( T );
+		if ( field.offset == 0 || target < 0 || (uint64_t)target + bytes > mSize || target % align != 0 )
+		{
+			mError = "offset out of bounds";
+			return nullptr;
+		}
+		return (const T*)(mBase + target);
+	}
+
+	template<typename T>
+	bool CheckArray( const AssetArray<T> &array )
+	{
+		return array.count == 0 || Resolve( array.data,array.count ) != nullptr;
+	}
+
+	bool CheckString( const AssetString &string )
+	{
+		if ( string.chars.count == 0 )
+		{
+			return true;
+		}
+		const char *chars = Resolve( string.chars.data,string.chars.count );
+		return chars ? (chars[string.chars.count - 1] == 0 || Fail( "string not terminated" )) : false;
+	}
+
+	bool CheckChannel( const AssetChannel &channel,int components )
+	{
+		switch ( channel.channelClass )
+		{
+		case (uint8_t)ChannelClass::Default:
+			return true;
+		case (uint8_t)ChannelClass::Constant:
+			if ( channel.components != components )
+			{
+				return Fail( "bad channel components" );
+			}
+			return Resolve( channel.values,components ) != nullptr;
+		case (uint8_t)ChannelClass::Animated:
+		{
+			if ( channel.components != components || channel.keyCount < 2 || channel.keyCount > 0x3FFFFFFFu / components )
+			{
+				return Fail( "bad animated channel" );
+			}
+			const float *times = Resolve( channel.times,channel.keyCount );
+			if ( !times || !Resolve( channel.values,channel.keyCount * 4 * components ) )
+			{
+				return false;
+			}
+			for ( uint32_t i = 1; i < channel.keyCount; ++i )
+			{
+				if ( !(times[i] >= times[i - 1]) || !isfinite( times[i] ) )
+				{
+					return Fail( "channel times not sorted" );
+				}
+			}
+			return true;
+		}
+		default:
+			return Fail( "bad channel class" );
+		}
+	}
+
+	bool CheckSkeleton( const AssetSkeleton &skeleton )
+	{
+		unsigned int size = skeleton.parents.count;
+		if ( skeleton.restPose.count != size || skeleton.bindPose.count != size ||
+			skeleton.invBindPose.count != size || skeleton.names.count != size )
+		{
+			return Fail( "skeleton array sizes differ" );
+		}
+		if ( size > 0x7FFF )
+		{
+			return Fail( "too many joints" );
+		}
+		if ( !CheckArray( skeleton.parents ) || !CheckArray( skeleton.restPose ) || !CheckArray( skeleton.bindPose ) ||
+			!CheckArray( skeleton.invBindPose ) || !CheckArray( skeleton.names ) )
+		{
+			return false;
+		}
+		for ( unsigned int i = 0; i < size; ++i )
+		{
+			int parent = skeleton.parents[i];
+			if ( parent < -1 || parent >= (int)i )
+			{
+				return Fail( "joints not topologically sorted" );
+			}
+			if ( !CheckString( skeleton.names[i] ) )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool CheckClip( const AssetClip &clip,unsigned int joints )
+	{
+		if ( !isfinite( clip.startTime ) || !isfinite( clip.endTime ) || clip.endTime < clip.startTime )
+		{
+			return Fail( "bad clip range" );
+		}
+		if ( !CheckString( clip.name ) || !CheckArray( clip.tracks ) )
+		{
+			return false;
+		}
+		for ( unsigned int i = 0; i < clip.tracks.count; ++i )
+		{
+			const AssetTrack &track = clip.tracks[i];
+			if ( track.joint >= joints )
+			{
+				return Fail( "track joint out of range" );
+			}
+			if ( !CheckChannel( track.position,3 ) || !CheckChannel( track.rotation,4 ) || !CheckChannel( track.scale,3 ) )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+public:
+	AnimationAssetValidator() : mBase( nullptr ),mSize( 0 ),mError( nullptr ) {}
+
+	bool Validate( const void *data,size_t size )
+	{
+		mBase = (const char*)data;
+		mSize = size;
+		mError = nullptr;
+		if ( !data || ((uintptr_t)data & 3) != 0 )
+		{
+			return Fail( "buffer not 4 byte aligned" );
+		}
+		if ( size < sizeof( AssetHeader ) )
+		{
+			return Fail( "too small for a header" );
+		}
+		const AssetHeader &header = *(const AssetHeader*)data;
+		if ( header.magic != ANIMATION_ASSET_MAGIC )
+		{
+			return Fail( "not an animation asset" );
+		}
+		if ( header.version != ANIMATION_ASSET_VERSION )
+		{
+			return Fail( "unsupported version" );
+		}
+		if ( header.size != size )
+		{
+			return Fail( "size mismatch, file truncated?" );
+		}
+		const AssetSkeleton *skeleton = Resolve( header.skeleton,1 );
+		if ( !skeleton )
+		{
+			return Fail( "missing skeleton" );
+		}
+		if ( !CheckSkeleton( *skeleton ) || !CheckArray( header.clips ) )
+		{
+			return false;
+		}
+		for ( unsigned int i = 0; i < header.clips.count; ++i )
+		{
+			if ( !CheckClip( header.clips[i],skeleton->Size() ) )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	const char* GetError() const { return mError; }
+};
+
+inline bool validateAnimationAsset( const void *data,size_t size,const char **error = nullptr )
+{
+	AnimationAssetValidator validator;
+	bool valid = validator.Validate( data,size );
+	if ( error )
+	{
+		*error = validator.GetError();
+	}
+	return valid;
+}
+
+// A validated asset, either mapped from a file (pages shared with every
+// other process mapping it, through the page cache) or attached to memory
+// the caller keeps alive.
+class AnimationAsset
+{
+protected:
+	MappedFile mFile;
+	const AssetHeader *mHeader;
+public:
+	AnimationAsset() : mHeader( nullptr ) {}
+
+	bool Open( const char *path,const char **error = nullptr )
+	{
+		Close();
+		if ( !mFile.Open( path ) )
+		{
+			if ( error )
+			{
+				*error = "cannot map file";
+			}
+			return false;
+		}
+		if ( !Attach( mFile.Data(),mFile.Size(),error ) )
+		{
+			mFile.Close();
+			return false;
+		}
+		return true;
+	}
+
+	// data must stay alive and unchanged while the asset is used.
+	bool Attach( const void *data,size_t size,const char **error = nullptr )
+	{
+		mHeader = validateAnimationAsset( data,size,error ) ? (const AssetHeader*)data : nullptr;
+		return mHeader != nullptr;
+	}
+
+	void Close()
+	{
+		mHeader = nullptr;
+		mFile.Close();
+	}
+
+	bool IsLoaded() const { return mHeader != nullptr; }
+	const AssetSkeleton& GetSkeleton() const { return *mHeader->skeleton.Get(); }
+	unsigned int GetClipCount() const { return mHeader->clips.count; }
+	const AssetClip& GetClip( unsigned int index ) const { return mHeader->clips[index]; }
+	size_t GetSizeInBytes() const { return mHeader ? mHeader->size : 0; }
+
+	const AssetClip* FindClip( const char *name ) const
+	{
+		for ( unsigned int i = 0, size = GetClipCount(); i < size; ++i )
+		{
+			if ( strcmp( mHeader->clips[i].GetName(),name ) == 0 )
+			{
+				return &mHeader->clips[i];
+			}
+		}
+		return nullptr;
+	}
+};
+
+// Builds the file image in memory. Structures are placed first and linked
+// by position, since the buffer moves while it grows.
+class AnimationAssetWriter
+{
+protected:
+	std::vector<char> mBuffer;
+
+	size_t Allocate( size_t bytes )
+	{
+		size_t position = (mBuffer.size() + 3) & ~(size_t)3;
+		mBuffer.resize( position + bytes,0 );
+		return position;
+	}
+
+	template<typename T>
+	void Write( size_t position,const T &value ) { memcpy( mBuffer.data() + position,&value,sizeof( T ) ); }
+
+	void Link( size_t field,size_t target )
+	{
+		Write( field,(int32_t)((int64_t)target - (int64_t)field) );
+	}
+
+	// field is the position of an AssetArray<T>.
+	template<typename T>
+	size_t WriteArray( size_t field,const T *data,uint32_t count )
+	{
+		size_t position = Allocate( (size_t)count * sizeof( T ) );
+		if ( count )
+		{
+			if ( data )
+			{
+				memcpy( mBuffer.data() + position,data,(size_t)count * sizeof( T ) );
+			}
+			Link( field + offsetof( AssetArray<T>,data ),position );
+		}
+		Write( field + offsetof( AssetArray<T>,count ),count );
+		return position;
+	}
+
+	void WriteString( size_t field,const std::string &string )
+	{
+		WriteArray( field + offsetof( AssetString,chars ),string.c_str(),(uint32_t)string.size() + 1 );
+	}
+
+	template<typename T,int N>
+	void WriteChannel( size_t field,const Track<T,N> &track,const T &rest,float epsilon )
+	{
+		ChannelClass channelClass = classifyChannel( track,rest,epsilon );
+		Write( field + offsetof( AssetChannel,channelClass ),(uint8_t)channelClass );
+		if ( channelClass == ChannelClass::Default )
+		{
+			return;
+		}
+		Write( field + offsetof( AssetChannel,components ),(uint8_t)N );
+		if ( channelClass == ChannelClass::Constant )
+		{
+			T value = TTrackValue<T>::cast( track[0].mValue );
+			size_t position = Allocate( N * sizeof( float ) );
+			memcpy( mBuffer.data() + position,&value,N * sizeof( float ) );
+			Write( field + offsetof( AssetChannel,keyCount ),(uint32_t)1 );
+			Link( field + offsetof( AssetChannel,values ),position );
+			return;
+		}
+		PolynomialTrack<T,N> polynomial( track );
+		Write( field + offsetof( AssetChannel,keyCount ),polynomial.Size() );
+		size_t times = Allocate( polynomial.Size() * sizeof( float ) );
+		memcpy( mBuffer.data() + times,polynomial.GetTimes(),polynomial.Size() * sizeof( float ) );
+		Link( field + offsetof( AssetChannel,times ),times );
+		size_t values = Allocate( polynomial.GetCoefficientBytes() );
+		memcpy( mBuffer.data() + values,polynomial.GetCoefficients(),polynomial.GetCoefficientBytes() );
+		Link( field + offsetof( AssetChannel,values ),values );
+	}
+
+	static AssetTransform ToAsset( const Transform &t )
+	{
+		AssetTransform result;
+		memcpy( result.position,t.position.v,sizeof( result.position ) );
+		memcpy( result.rotation,t.rotation.v,sizeof( result.rotation ) );
+		memcpy( result.scale,t.scale.v,sizeof( result.scale ) );
+		return result;
+	}
+
+	void WritePose( size_t field,const Pose &pose )
+	{
+		std::vector<AssetTransform> transforms( pose.Size() );
+		for ( unsigned int i = 0; i < pose.Size(); ++i )
+		{
+			transforms[i] = ToAsset( pose.GetLocalTransform( i ) );
+		}
+		WriteArray( field,transforms.data(),pose.Size() );
+	}
+
+	void WriteClip( size_t field,const Pose &rest,const Clip &clip,float epsilon )
+	{
+		WriteString( field + offsetof( AssetClip,name ),clip.GetName() );
+		// The source's time range, as TClassifiedClip::Load keeps it.
+		Write( field + offsetof( AssetClip,startTime ),clip.GetStartTime() );
+		Write( field + offsetof( AssetClip,endTime ),clip.GetEndTime() );
+		Write( field + offsetof( AssetClip,looping ),(uint32_t)clip.GetLooping() );
+
+		// Tracks with every channel at rest are dropped.
+		std::vector<unsigned int> kept;
+		for ( unsigned int i = 0; i < clip.Size(); ++i )
+		{
+			const TransformTrack &track = clip.GetTrackAtIndex( i );
+			const Transform &r = rest.GetLocalTransform( track.GetId() );
+			if ( classifyChannel( track.GetPositionTrack(),r.position,epsilon ) != ChannelClass::Default ||
+				classifyChannel( track.GetRotationTrack(),r.rotation,epsilon ) != ChannelClass::Default ||
+				classifyChannel( track.GetScaleTrack(),r.scale,epsilon ) != ChannelClass::Default )
+			{
+				kept.push_back( i );
+			}
+		}
+		size_t tracks = WriteArray<AssetTrack>( field + offsetof( AssetClip,tracks ),nullptr,(uint32_t)kept.size() );
+		for ( size_t k = 0; k < kept.size(); ++k )
+		{
+			const TransformTrack &track = clip.GetTrackAtIndex( kept[k] );
+			const Transform &r = rest.GetLocalTransform( track.GetId() );
+			size_t t = tracks + k * sizeof( AssetTrack );
+			Write( t + offsetof( AssetTrack,joint ),(uint32_t)track.GetId() );
+			WriteChannel( t + offsetof( AssetTrack,position ),track.GetPositionTrack(),r.position,epsilon );
+			WriteChannel( t + offsetof( AssetTrack,rotation ),track.GetRotationTrack(),r.rotation,epsilon );
+			WriteChannel( t + offsetof( AssetTrack,scale ),track.GetScaleTrack(),r.scale,epsilon );
+		}
+	}
+public:
+	// Channels are classified against the skeleton's rest pose, which is what
+	// the clips must be sampled onto. Fails on joints the skeleton lacks, an
+	// unsorted skeleton, or data past the 2 GB that offsets can span.
+	bool Build( const Skeleton &skeleton,const Clip *const *clips,unsigned int count,float epsilon = CHANNEL_CLASS_EPSILON )
+	{
+		mBuffer.clear();
+		const Pose &rest = skeleton.GetRestPose();
+		unsigned int joints = skeleton.Size();
+		if ( rest.Size() != joints || joints > 0x7FFF || !skeleton.GetBindPose().IsTopologicallySorted() ||
+			!rest.IsTopologicallySorted() )
+		{
+			return false;
+		}
+		for ( unsigned int c = 0; c < count; ++c )
+		{
+			for ( unsigned int i = 0; i < clips[c]->Size(); ++i )
+			{
+				if ( clips[c]->GetIdAtIndex( i ) >= joints )
+				{
+					return false;
+				}
+			}
+		}
+
+		size_t header = Allocate( sizeof( AssetHeader ) );
+		Write( header + offsetof( AssetHeader,magic ),(uint32_t)ANIMATION_ASSET_MAGIC );
+		Write( header + offsetof( AssetHeader,version ),(uint32_t)ANIMATION_ASSET_VERSION );
+
+		size_t s = Allocate( sizeof( AssetSkeleton ) );
+		Link( header + offsetof( AssetHeader,skeleton ),s );
+		WriteArray( s + offsetof( AssetSkeleton,parents ),skeleton.GetBindPose().GetParents(),joints );
+		WritePose( s + offsetof( AssetSkeleton,restPose ),rest );
+		WritePose( s + offsetof( AssetSkeleton,bindPose ),skeleton.GetBindPose() );
+		WriteArray( s + offsetof( AssetSkeleton,invBindPose ),skeleton.GetInvBindPose3x4().data(),joints );
+		size_t names = WriteArray<AssetString>( s + offsetof( AssetSkeleton,names ),nullptr,joints );
+		for ( unsigned int i = 0; i < joints; ++i )
+		{
+			WriteString( names + i * sizeof( AssetString ),skeleton.GetJointName( i ) );
+		}
+
+		size_t table = WriteArray<AssetClip>( header + offsetof( AssetHeader,clips ),nullptr,count );
+		for ( unsigned int c = 0; c < count; ++c )
+		{
+			WriteClip( table + c * sizeof( AssetClip ),rest,*clips[c],epsilon );
+		}
+		if ( mBuffer.size() > 0x7FFFFFFF )
+		{
+			mBuffer.clear();
+			return false;
+		}
+		Write( header + offsetof( AssetHeader,size ),(uint32_t)mBuffer.size() );
+		return true;
+	}
+
+	const std::vector<char>& GetBuffer() const { return mBuffer; }
+
+	bool Save( const char *path ) const
+	{
+		FILE *file = fopen( path,"wb" );
+		if ( !file )
+		{
+			return false;
+		}
+		bool written = fwrite( mBuffer.data(),1,mBuffer.size(),file ) == mBuffer.size();
+		return fclose( file ) == 0 && written;
+	}
+};
+
+inline bool writeAnimationAsset( const char *path,const Skeleton &skeleton,const Clip *const *clips,unsigned int count,
+	float epsilon = CHANNEL_CLASS_EPSILON )
+{
+	AnimationAssetWriter writer;
+	return writer.Build( skeleton,clips,count,epsilon ) && writer.Save( path );
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include "Benchmark.h"
+#include "AnimTextureBenchmark.h"
+#include "ClassifiedClipBenchmark.h"
+#include "AnimationAsset.h"
+
+// Load time of a library of clips: building runtime clips from source data,
+// reading the asset file into memory, and mapping it in place. Mapping
+// costs the same for any file size; pages are read (or found already
+// resident in the page cache) on first touch, then sampling is as fast as
+// from PolynomialClip.
+
+inline void benchmarkAnimationAsset( const char *path = "benchmark.anim",unsigned int clipCount = 64,
+	unsigned int joints = 60,float duration = 4.0f,unsigned int loads = 20,unsigned int samples = 20000 )
+{
+	srand( 11 );
+	Pose rest;
+	fillBenchmarkPose( rest,joints );
+	for ( unsigned int i = 1; i < joints; ++i )
+	{
+		rest.SetParent( i,(int)(i - 1) / 4 );
+	}
+	Skeleton skeleton( rest,rest,std::vector<std::string>( joints,"joint" ) );
+	std::vector<Clip> clips( clipCount );
+	std::vector<const Clip*> pointers( clipCount );
+	for ( unsigned int c = 0; c < clipCount; ++c )
+	{
+		fillExportedBenchmarkClip( rest,clips[c],duration,30.0f,0.25f,0.1f );
+		clips[c].SetName( "clip" + std::to_string( c ) );
+		pointers[c] = &clips[c];
+	}
+	AnimationAssetWriter writer;
+	if ( !writer.Build( skeleton,pointers.data(),clipCount ) || !writer.Save( path ) )
+	{
+		std::cout << "cannot write " << path << "\n";
+		return;
+	}
+	size_t size = writer.GetBuffer().size();
+	std::cout << clipCount << " clips, " << joints << " joints: source keys " << clipKeyBytes( clips[0] ) * clipCount
+		<< " bytes, asset " << size << " bytes\n";
+
+	BenchmarkResult r = runBenchmark( "precompute clips",loads,[&]()
+	{
+		for ( unsigned int i = 0; i < loads; ++i )
+		{
+			std::vector<PolynomialClip> loaded( clipCount );
+			for ( unsigned int c = 0; c < clipCount; ++c )
+			{
+				loaded[c] = PrecomputeClip( clips[c] );
+			}
+			benchmarkSink() = loaded.back().GetDuration();
+		}
+	} );
+	printBenchmark( r,"loads" );
+
+	std::vector<uint32_t> storage( (size + 3) / 4 );
+	r = runBenchmark( "fread + validate",loads,[&]()
+	{
+		for ( unsigned int i = 0; i < loads; ++i )
+		{
+			FILE *file = fopen( path,"rb" );
+			size_t read = file ? fread( storage.data(),1,size,file ) : 0;
+			if ( file )
+			{
+				fclose( file );
+			}
+			AnimationAsset asset;
+			benchmarkSink() = read == size && asset.Attach( storage.data(),size ) ? asset.GetClip( 0 ).GetDuration() : 0.0f;
+		}
+	} );
+	printBenchmark( r,"loads" );
+
+	r = runBenchmark( "mmap + validate",loads,[&]()
+	{
+		for ( unsigned int i = 0; i < loads; ++i )
+		{
+			AnimationAsset asset;
+			benchmarkSink() = asset.Open( path ) ? asset.GetClip( 0 ).GetDuration() : 0.0f;
+		}
+	} );
+	printBenchmark( r,"loads" );
+
+	AnimationAsset asset;
+	const char *error = nullptr;
+	if ( !asset.Open( path,&error ) )
+	{
+		std::cout << "cannot open " << path << ": " << error << "\n";
+		return;
+	}
+	PolynomialClip polynomial = PrecomputeClip( clips[0] );
+	const AssetClip &mapped = asset.GetClip( 0 );
+	Pose a = rest,b = rest;
+	float maxError = 0.0f;
+	for ( unsigned int i = 0; i < 200; ++i )
+	{
+		float time = duration * float( i ) / 200.0f;
+		a = rest;
+		b = rest;
+		polynomial.Sample( a,time );
+		mapped.Sample( b,time );
+		for ( unsigned int j = 0; j < joints; ++j )
+		{
+			const Transform &ta = a.GetLocalTransform( j );
+			const Transform &tb = b.GetLocalTransform( j );
+			for ( int k = 0; k < 4; ++k )
+			{
+				float d = fabsf( ta.rotation.v[k] - tb.rotation.v[k] );
+				maxError = d > maxError ? d : maxError;
+			}
+			for ( int k = 0; k < 3; ++k )
+			{
+				float d = fabsf( ta.position.v[k] - tb.position.v[k] );
+				maxError = d > maxError ? d : maxError;
+			}
+		}
+	}
+	std::cout << "max difference, mapped vs polynomial clip: " << maxError << "\n";
+	printBenchmark( benchmarkClipSampling( "sample polynomial clip",rest,polynomial,samples ),"poses" );
+	printBenchmark( benchmarkClipSampling( "sample mapped clip",rest,mapped,samples ),"poses" );
+	asset.Close();
+	remove( path );
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <chrono>
+#include <iostream>
+
+// Minimal timing harness for the *Benchmark.h headers. Results are returned
+// so callers can compare them, and printed in a fixed one-line format.
+
+struct BenchmarkResult
+{
+	const char *name;
+	double items;
+	double seconds;
+	double ItemsPerSecond() const { return seconds > 0.0 ? items / seconds : 0.0; }
+};
+
+// Written by benchmark bodies so the optimizer cannot drop the work.
+inline volatile float& benchmarkSink()
+{
+	static volatile float sink = 0.0f;
+	return sink;
+}
+
+template<typename F>
+BenchmarkResult runBenchmark( const char *name,double items,F body )
+{
+	body(); // warm caches and page in the data
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	body();
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	BenchmarkResult result;
+	result.name = name;
+	result.items = items;
+	result.seconds = std::chrono::duration<double>( end - start ).count();
+	return result;
+}
+
+inline void printBenchmark( const BenchmarkResult &r,const char *unit )
+{
+	std::cout << r.name << ": " << r.ItemsPerSecond() << " " << unit << "/s ("
+		<< r.seconds * 1000.0 << " ms)\n";
+}
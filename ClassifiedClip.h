@@ -0,0 +1,225 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include <math.h>
+#include "Clip.h"
+
+// Channels are classified once at load time against the rest pose:
+// Default channels hold the rest value the whole clip (or have fewer than
+// two keys, which Clip never samples either), Constant channels hold one
+// other value, and only Animated channels keep their keys.
+enum class ChannelClass : uint8_t
+{
+	Default,
+	Constant,
+	Animated
+};
+
+#define CHANNEL_CLASS_EPSILON 0.00001f
+
+inline bool channelValueEqual( const vec3 &a,const vec3 &b,float epsilon )
+{
+	return fabsf( a.v[0] - b.v[0] ) <= epsilon && fabsf( a.v[1] - b.v[1] ) <= epsilon && fabsf( a.v[2] - b.v[2] ) <= epsilon;
+}
+
+// q and -q are the same rotation.
+inline bool channelValueEqual( const quat &a,const quat &b,float epsilon )
+{
+	float s = dot( a,b ) < 0.0f ? -1.0f : 1.0f;
+	return fabsf( a.v[0] - b.v[0] * s ) <= epsilon && fabsf( a.v[1] - b.v[1] * s ) <= epsilon &&
+		fabsf( a.v[2] - b.v[2] * s ) <= epsilon && fabsf( a.v[3] - b.v[3] * s ) <= epsilon;
+}
+
+template<typename T,int N>
+ChannelClass classifyChannel( const Track<T,N> &track,const T &rest,float epsilon = CHANNEL_CLASS_EPSILON )
+{
+	if ( track.Size() <= 1 )
+	{
+		return ChannelClass::Default;
+	}
+	T first = TTrackValue<T>::cast( track[0].mValue );
+	for ( unsigned int i = 1; i < track.Size(); ++i )
+	{
+		if ( !channelValueEqual( first,TTrackValue<T>::cast( track[i].mValue ),epsilon ) )
+		{
+			return ChannelClass::Animated;
+		}
+		// Flat keys can still bend between them with the tangents of the
+		// segment: key i - 1's out and key i's in.
+		if ( track.GetInterpolation() == Interpolation::Cubic &&
+			(!channelValueEqual( TTrackValue<T>::raw( track[i - 1].mOut ),T(),epsilon ) ||
+			!channelValueEqual( TTrackValue<T>::raw( track[i].mIn ),T(),epsilon )) )
+		{
+			return ChannelClass::Animated;
+		}
+	}
+	return channelValueEqual( first,rest,epsilon ) ? ChannelClass::Default : ChannelClass::Constant;
+}
+
+struct ChannelClassCounts
+{
+	unsigned int defaults;
+	unsigned int constants;
+	unsigned int animated;
+	unsigned int Total() const { return defaults + constants + animated; }
+};
+
+inline void copyAnimatedTrack( const VectorTrack &in,VectorTrack &out ) { out = in; }
+inline void copyAnimatedTrack( const QuaternionTrack &in,QuaternionTrack &out ) { out = in; }
+inline void copyAnimatedTrack( const VectorTrack &in,FastVectorTrack &out ) { out = OptimizeTrack( in ); }
+inline void copyAnimatedTrack( const QuaternionTrack &in,FastQuaternionTrack &out ) { out = OptimizeTrack( in ); }
+inline void copyAnimatedTrack( const VectorTrack &in,PolynomialVectorTrack &out ) { out.Build( in ); }
+inline void copyAnimatedTrack( const QuaternionTrack &in,PolynomialQuaternionTrack &out ) { out.Build( in ); }
+
+// A clip with its channels split by class. Default channels are dropped,
+// constant ones are kept as one value each in packed per component arrays
+// that Sample writes in a straight loop, and the animated ones stay tracks
+// (with their static components left empty). Sample only ever touches the
+// channels a clip changes, so into a rest pose it gives the same result as
+// the source Clip.
+template<typename TRACK>
+class TClassifiedClip
+{
+protected:
+	std::vector<TRACK> mAnimated;
+	std::vector<uint16_t> mConstantPositionJoints;
+	std::vector<vec3> mConstantPositions;
+	std::vector<uint16_t> mConstantRotationJoints;
+	std::vector<quat> mConstantRotations;
+	std::vector<uint16_t> mConstantScaleJoints;
+	std::vector<vec3> mConstantScales;
+	ChannelClassCounts mCounts;
+	std::string mName;
+	float mStartTime;
+	float mEndTime;
+	bool mLooping;
+
+	template<typename T,int N,typename OUT>
+	bool AddChannel( const Track<T,N> &track,const T &rest,float epsilon,OUT &animated,
+		std::vector<uint16_t> &constantJoints,std::vector<T> &constants,unsigned int joint )
+	{
+		switch ( classifyChannel( track,rest,epsilon ) )
+		{
+		case ChannelClass::Default:
+			++mCounts.defaults;
+			return false;
+		case ChannelClass::Constant:
+			++mCounts.constants;
+			constantJoints.push_back( (uint16_t)joint );
+			constants.push_back( TTrackValue<T>::cast( track[0].mValue ) );
+			return false;
+		default:
+			++mCounts.animated;
+			copyAnimatedTrack( track,animated );
+			return true;
+		}
+	}
+public:
+	TClassifiedClip() : mCounts{ 0,0,0 },mStartTime( 0.0f ),mEndTime( 0.0f ),mLooping( true ) {}
+
+	// rest is the pose the clip is played on, normally the skeleton's rest pose.
+	void Load( const Pose &rest,const Clip &clip,float epsilon = CHANNEL_CLASS_EPSILON )
+	{
+		*this = TClassifiedClip();
+		mName = clip.GetName();
+		mLooping = clip.GetLooping();
+		// The source's time range, so playback speed and looping match even
+		// when the static channels were the longest ones.
+		mStartTime = clip.GetStartTime();
+		mEndTime = clip.GetEndTime();
+		for ( unsigned int i = 0; i < clip.Size(); ++i )
+		{
+			const TransformTrack &source = clip.GetTrackAtIndex( i );
+			unsigned int joint = source.GetId();
+			const Transform &r = rest.GetLocalTransform( joint );
+			TRACK track;
+			track.SetId( joint );
+			bool animated = AddChannel( source.GetPositionTrack(),r.position,epsilon,track.GetPositionTrack(),
+				mConstantPositionJoints,mConstantPositions,joint );
+			animated |= AddChannel( source.GetRotationTrack(),r.rotation,epsilon,track.GetRotationTrack(),
+				mConstantRotationJoints,mConstantRotations,joint );
+			animated |= AddChannel( source.GetScaleTrack(),r.scale,epsilon,track.GetScaleTrack(),
+				mConstantScaleJoints,mConstantScales,joint );
+			if ( animated )
+			{
+				mAnimated.push_back( track );
+			}
+		}
+	}
+
+	float AdjustTimeToFitRange( float time ) const
+	{
+		float duration = mEndTime - mStartTime;
+		if ( duration <= 0.0f )
+		{
+			return mStartTime;
+		}
+		if ( mLooping )
+		{
+			time = fmodf( time - mStartTime,duration );
+			if ( time < 0.0f )
+			{
+				time += duration;
+			}
+			return time + mStartTime;
+		}
+		return time < mStartTime ? mStartTime : (time > mEndTime ? mEndTime : time);
+	}
+
+	// Writes the constant channels. Default channels are never written:
+	// out must already hold the rest pose for them.
+	void ApplyStatic( Pose &out ) const
+	{
+		Transform *local = out.GetLocalTransforms();
+		for ( size_t i = 0, size = mConstantPositions.size(); i < size; ++i )
+		{
+			local[mConstantPositionJoints[i]].position = mConstantPositions[i];
+		}
+		for ( size_t i = 0, size = mConstantRotations.size(); i < size; ++i )
+		{
+			local[mConstantRotationJoints[i]].rotation = mConstantRotations[i];
+		}
+		for ( size_t i = 0, size = mConstantScales.size(); i < size; ++i )
+		{
+			local[mConstantScaleJoints[i]].scale = mConstantScales[i];
+		}
+	}
+
+	// Only the animated channels. A pose that ApplyStatic was called on once
+	// and that nothing else writes stays complete with just this per frame.
+	float SampleAnimated( Pose &out,float time ) const
+	{
+		if ( GetDuration() == 0.0f )
+		{
+			return 0.0f;
+		}
+		time = AdjustTimeToFitRange( time );
+		Transform *local = out.GetLocalTransforms();
+		for ( size_t i = 0, size = mAnimated.size(); i < size; ++i )
+		{
+			unsigned int joint = mAnimated[i].GetId();
+			local[joint] = mAnimated[i].Sample( local[joint],time,mLooping );
+		}
+		return time;
+	}
+
+	float Sample( Pose &out,float time ) const
+	{
+		ApplyStatic( out );
+		return SampleAnimated( out,time );
+	}
+
+	const ChannelClassCounts& GetChannelCounts() const { return mCounts; }
+	unsigned int GetAnimatedTrackCount() const { return (unsigned int)mAnimated.size(); }
+	const std::string& GetName() const { return mName; }
+	float GetDuration() const { return mEndTime - mStartTime; }
+	float GetStartTime() const { return mStartTime; }
+	float GetEndTime() const { return mEndTime; }
+	bool GetLooping() const { return mLooping; }
+	void SetLooping( bool looping ) { mLooping = looping; }
+};
+
+typedef TClassifiedClip<TransformTrack> ClassifiedClip;
+typedef TClassifiedClip<FastTransformTrack> FastClassifiedClip;
+typedef TClassifiedClip<PolynomialTransformTrack> PolynomialClassifiedClip;
@@ -0,0 +1,99 @@
+#pragma once
+#include <vector>
+#include <stdlib.h>
+#include "Benchmark.h"
+#include "KeyReductionBenchmark.h"
+#include "ClassifiedClip.h"
+
+// Channel classification on export-like data: every channel of every joint
+// keyed every frame, bone lengths and scales never changing, and a share of
+// joints (fingers, props) holding a fixed rotation, some of them the rest one.
+
+inline void fillExportedBenchmarkClip( const Pose &rest,Clip &clip,float duration,float fps,
+	float constantShare,float defaultShare )
+{
+	unsigned int joints = rest.Size();
+	fillBenchmarkClip( clip,joints,duration,fps );
+	for ( unsigned int j = 0; j < joints; ++j )
+	{
+		TransformTrack &track = clip[j];
+		unsigned int keys = track.GetRotationTrack().Size();
+		const Transform &r = rest.GetLocalTransform( j );
+		VectorTrack &position = track.GetPositionTrack();
+		VectorTrack &scale = track.GetScaleTrack();
+		if ( j != 0 )
+		{
+			position = VectorTrack();
+			position.Resize( keys );
+		}
+		scale.Resize( keys );
+		float pick = float( rand() ) / float( RAND_MAX );
+		QuaternionTrack &rotation = track.GetRotationTrack();
+		quat fixed = pick < defaultShare ? r.rotation : rotation[0].mValue[3] >= 0.0f ?
+			TTrackValue<quat>::cast( rotation[0].mValue ) : -TTrackValue<quat>::cast( rotation[0].mValue );
+		for ( unsigned int k = 0; k < keys; ++k )
+		{
+			float t = rotation[k].mTime;
+			if ( j != 0 )
+			{
+				position[k].mTime = t;
+				for ( int c = 0; c < 3; ++c )
+				{
+					position[k].mValue[c] = r.position.v[c];
+				}
+			}
+			scale[k].mTime = t;
+			for ( int c = 0; c < 3; ++c )
+			{
+				scale[k].mValue[c] = r.scale.v[c];
+			}
+			if ( pick < constantShare + defaultShare )
+			{
+				for ( int c = 0; c < 4; ++c )
+				{
+					rotation[k].mValue[c] = fixed.v[c];
+				}
+			}
+		}
+	}
+	clip.RecalculateDuration();
+}
+
+inline void benchmarkClassifiedClip( unsigned int joints = 60,float duration = 4.0f,float fps = 30.0f,unsigned int samples = 20000 )
+{
+	srand( 5 );
+	Pose rest;
+	fillBenchmarkPose( rest,joints );
+	for ( unsigned int i = 1; i < joints; ++i )
+	{
+		rest.SetParent( i,(int)(i - 1) / 4 );
+	}
+	Clip clip;
+	fillExportedBenchmarkClip( rest,clip,duration,fps,0.25f,0.1f );
+	ClassifiedClip classified;
+	classified.Load( rest,clip );
+	FastClassifiedClip fastClassified;
+	fastClassified.Load( rest,clip );
+	FastClip fast = OptimizeClip( clip );
+	const ChannelClassCounts &counts = classified.GetChannelCounts();
+	std::cout << "channels: " << counts.defaults << " default, " << counts.constants << " constant, "
+		<< counts.animated << " animated (" << 100.0f * float( counts.defaults + counts.constants ) / float( counts.Total() )
+		<< "% static)\n";
+
+	printBenchmark( benchmarkClipSampling( "sample clip",rest,clip,samples ),"poses" );
+	printBenchmark( benchmarkClipSampling( "sample classified",rest,classified,samples ),"poses" );
+	printBenchmark( benchmarkClipSampling( "sample fast clip",rest,fast,samples ),"poses" );
+	printBenchmark( benchmarkClipSampling( "sample fast classified",rest,fastClassified,samples ),"poses" );
+
+	Pose pose = rest;
+	fastClassified.ApplyStatic( pose );
+	BenchmarkResult r = runBenchmark( "sample fast classified, animated only",samples,[&]()
+	{
+		for ( unsigned int i = 0; i < samples; ++i )
+		{
+			fastClassified.SampleAnimated( pose,float( i ) * 0.00731f );
+		}
+		benchmarkSink() = pose.GetLocalTransform( 0 ).rotation.x;
+	} );
+	printBenchmark( r,"poses" );
+}
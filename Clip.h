@@ -0,0 +1,273 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <math.h>
+#include "Track.h"
+#include "FastTrack.h"
+#include "PolynomialTrack.h"
+#include "Pose.h"
+
+// Position, rotation and scale tracks for one joint. A component with fewer
+// than two keys is not animated and keeps the value of the pose it samples into.
+template<typename VTRACK,typename QTRACK>
+class TTransformTrack
+{
+protected:
+	unsigned int mId;
+	VTRACK mPosition;
+	QTRACK mRotation;
+	VTRACK mScale;
+public:
+	TTransformTrack() : mId( 0 ) {}
+
+	unsigned int GetId() const { return mId; }
+	void SetId( unsigned int id ) { mId = id; }
+	VTRACK& GetPositionTrack() { return mPosition; }
+	QTRACK& GetRotationTrack() { return mRotation; }
+	VTRACK& GetScaleTrack() { return mScale; }
+	const VTRACK& GetPositionTrack() const { return mPosition; }
+	const QTRACK& GetRotationTrack() const { return mRotation; }
+	const VTRACK& GetScaleTrack() const { return mScale; }
+
+	bool IsValid() const { return mPosition.Size() > 1 || mRotation.Size() > 1 || mScale.Size() > 1; }
+
+	// Earliest start of the animated components, 0 if none is animated.
+	float GetStartTime() const
+	{
+		float result = 0.0f;
+		bool isSet = false;
+		if ( mPosition.Size() > 1 )
+		{
+			result = mPosition.GetStartTime();
+			isSet = true;
+		}
+		if ( mRotation.Size() > 1 && (!isSet || mRotation.GetStartTime() < result) )
+		{
+			result = mRotation.GetStartTime();
+			isSet = true;
+		}
+		if ( mScale.Size() > 1 && (!isSet || mScale.GetStartTime() < result) )
+		{
+			result = mScale.GetStartTime();
+		}
+		return result;
+	}
+
+	// Latest end of the animated components, 0 if none is animated.
+	float GetEndTime() const
+	{
+		float result = 0.0f;
+		bool isSet = false;
+		if ( mPosition.Size() > 1 )
+		{
+			result = mPosition.GetEndTime();
+			isSet = true;
+		}
+		if ( mRotation.Size() > 1 && (!isSet || mRotation.GetEndTime() > result) )
+		{
+			result = mRotation.GetEndTime();
+			isSet = true;
+		}
+		if ( mScale.Size() > 1 && (!isSet || mScale.GetEndTime() > result) )
+		{
+			result = mScale.GetEndTime();
+		}
+		return result;
+	}
+
+	Transform Sample( const Transform &ref,float time,bool looping ) const
+	{
+		Transform result = ref;
+		if ( mPosition.Size() > 1 )
+		{
+			result.position = mPosition.Sample( time,looping );
+		}
+		if ( mRotation.Size() > 1 )
+		{
+			result.rotation = mRotation.Sample( time,looping );
+		}
+		if ( mScale.Size() > 1 )
+		{
+			result.scale = mScale.Sample( time,looping );
+		}
+		return result;
+	}
+};
+
+typedef TTransformTrack<VectorTrack,QuaternionTrack> TransformTrack;
+typedef TTransformTrack<FastVectorTrack,FastQuaternionTrack> FastTransformTrack;
+typedef TTransformTrack<PolynomialVectorTrack,PolynomialQuaternionTrack> PolynomialTransformTrack;
+
+// A named set of joint tracks. Joints without a track keep whatever the
+// output pose already holds, usually the rest pose.
+template<typename TRACK>
+class TClip
+{
+protected:
+	std::vector<TRACK> mTracks;
+	std::string mName;
+	float mStartTime;
+	float mEndTime;
+	bool mLooping;
+public:
+	TClip() : mName( "No name given" ),mStartTime( 0.0f ),mEndTime( 0.0f ),mLooping( true ) {}
+
+	unsigned int Size() const { return (unsigned int)mTracks.size(); }
+	unsigned int GetIdAtIndex( unsigned int index ) const { return mTracks[index].GetId(); }
+	void SetIdAtIndex( unsigned int index,unsigned int id ) { mTracks[index].SetId( id ); }
+	const TRACK& GetTrackAtIndex( unsigned int index ) const { return mTracks[index]; }
+
+	// Track for a joint, created on first use. Call RecalculateDuration once
+	// the tracks are filled in.
+	TRACK& operator[]( unsigned int joint )
+	{
+		for ( size_t i = 0; i < mTracks.size(); ++i )
+		{
+			if ( mTracks[i].GetId() == joint )
+			{
+				return mTracks[i];
+			}
+		}
+		mTracks.push_back( TRACK() );
+		mTracks.back().SetId( joint );
+		return mTracks.back();
+	}
+
+	void RecalculateDuration()
+	{
+		mStartTime = 0.0f;
+		mEndTime = 0.0f;
+		bool startSet = false;
+		bool endSet = false;
+		for ( size_t i = 0; i < mTracks.size(); ++i )
+		{
+			if ( !mTracks[i].IsValid() )
+			{
+				continue;
+			}
+			float start = mTracks[i].GetStartTime();
+			float end = mTracks[i].GetEndTime();
+			if ( !startSet || start < mStartTime )
+			{
+				mStartTime = start;
+				startSet = true;
+			}
+			if ( !endSet || end > mEndTime )
+			{
+				mEndTime = end;
+				endSet = true;
+			}
+		}
+	}
+
+	// Wraps (looping) or clamps the time into [start, end].
+	float AdjustTimeToFitRange( float time ) const
+	{
+		float duration = mEndTime - mStartTime;
+		if ( duration <= 0.0f )
+		{
+			return mStartTime;
+		}
+		if ( mLooping )
+		{
+			time = fmodf( time - mStartTime,duration );
+			if ( time < 0.0f )
+			{
+				time += duration;
+			}
+			return time + mStartTime;
+		}
+		return time < mStartTime ? mStartTime : (time > mEndTime ? mEndTime : time);
+	}
+
+	// Writes every animated joint into out and returns the adjusted time,
+	// which the caller feeds back in next frame.
+	float Sample( Pose &out,float time ) const
+	{
+		if ( GetDuration() == 0.0f )
+		{
+			return 0.0f;
+		}
+		time = AdjustTimeToFitRange( time );
+		Transform *local = out.GetLocalTransforms();
+		for ( size_t i = 0; i < mTracks.size(); ++i )
+		{
+			unsigned int joint = mTracks[i].GetId();
+			local[joint] = mTracks[i].Sample( local[joint],time,mLooping );
+		}
+		return time;
+	}
+
+	const std::string& GetName() const { return mName; }
+	void SetName( const std::string &name ) { mName = name; }
+	float GetDuration() const { return mEndTime - mStartTime; }
+	float GetStartTime() const { return mStartTime; }
+	float GetEndTime() const { return mEndTime; }
+	bool GetLooping() const { return mLooping; }
+	void SetLooping( bool looping ) { mLooping = looping; }
+};
+
+typedef TClip<TransformTrack> Clip;
+typedef TClip<FastTransformTrack> FastClip;
+typedef TClip<PolynomialTransformTrack> PolynomialClip;
+
+// Latest time at or before the end that clip.Sample plays without wrapping:
+// the end time itself, or for a looping clip (whose end wraps to the start
+// pose) the last float before it. For resampling a clip's final frame.
+template<typename CLIP>
+float clipLastSampleTime( const CLIP &clip )
+{
+	float time = clip.GetEndTime();
+	while ( time > clip.GetStartTime() && clip.AdjustTimeToFitRange( time ) < time )
+	{
+		time = nextafterf( time,clip.GetStartTime() );
+	}
+	return time;
+}
+
+inline FastTransformTrack OptimizeTransformTrack( const TransformTrack &input )
+{
+	FastTransformTrack result;
+	result.SetId( input.GetId() );
+	result.GetPositionTrack() = OptimizeTrack( input.GetPositionTrack() );
+	result.GetRotationTrack() = OptimizeTrack( input.GetRotationTrack() );
+	result.GetScaleTrack() = OptimizeTrack( input.GetScaleTrack() );
+	return result;
+}
+
+inline FastClip OptimizeClip( const Clip &input )
+{
+	FastClip result;
+	result.SetName( input.GetName() );
+	result.SetLooping( input.GetLooping() );
+	for ( unsigned int i = 0, size = input.Size(); i < size; ++i )
+	{
+		result[input.GetIdAtIndex( i )] = OptimizeTransformTrack( input.GetTrackAtIndex( i ) );
+	}
+	result.RecalculateDuration();
+	return result;
+}
+
+inline PolynomialTransformTrack PrecomputeTransformTrack( const TransformTrack &input )
+{
+	PolynomialTransformTrack result;
+	result.SetId( input.GetId() );
+	result.GetPositionTrack().Build( input.GetPositionTrack() );
+	result.GetRotationTrack().Build( input.GetRotationTrack() );
+	result.GetScaleTrack().Build( input.GetScaleTrack() );
+	return result;
+}
+
+// Load time preprocessing into per segment polynomials, see PolynomialTrack.h.
+inline PolynomialClip PrecomputeClip( const Clip &input )
+{
+	PolynomialClip result;
+	result.SetName( input.GetName() );
+	result.SetLooping( input.GetLooping() );
+	for ( unsigned int i = 0, size = input.Size(); i < size; ++i )
+	{
+		result[input.GetIdAtIndex( i )] = PrecomputeTransformTrack( input.GetTrackAtIndex( i ) );
+	}
+	result.RecalculateDuration();
+	return result;
+}
@@ -0,0 +1,200 @@
+#pragma once
+#include <vector>
+#include "Clip.h"
+#include "Skeleton.h"
+
+// Poses a controller keeps for in-flight fades unless told otherwise.
+#define CROSSFADE_DEFAULT_CAPACITY 4
+
+// A clip being faded in. mPose indexes the controller's pose pool.
+template<typename CLIP>
+struct TCrossFadeTarget
+{
+	const CLIP *mClip;
+	float mTime;
+	float mDuration;
+	float mElapsed;
+	unsigned int mPose;
+};
+
+// Plays a clip and fades to new ones over time. Every pose the controller
+// touches is set up once in SetSkeleton: the output pose and a pool with one
+// slot for the current clip plus one per in-flight fade. Play, FadeTo and
+// Update never allocate; finished targets hand their slot back to the free
+// list.
+//
+// Any number of FadeTo calls may overlap. Each target is blended over the
+// result of the ones before it. When the pool runs dry, the current clip and
+// the oldest target are merged into one held pose at the target's present
+// weight, which frees a slot without changing the output; the held pose
+// stands in for the current clip until a newer target finishes. When a target
+// reaches full weight every older one is dropped as invisible.
+template<typename CLIP>
+class TCrossFadeController
+{
+protected:
+	std::vector<Pose> mPosePool;
+	std::vector<unsigned int> mFreePoses;
+	std::vector<TCrossFadeTarget<CLIP>> mTargets;
+	Pose mOutput;
+	const Skeleton *mSkeleton;
+	const CLIP *mClip;
+	float mTime;
+	unsigned int mPose;
+	unsigned int mCapacity;
+	bool mHold;
+
+	void ReleaseTargets( unsigned int count )
+	{
+		for ( unsigned int i = 0; i < count; ++i )
+		{
+			mFreePoses.push_back( mTargets[i].mPose );
+		}
+		mTargets.erase( mTargets.begin(),mTargets.begin() + count );
+	}
+
+	// Target index replaces the current clip; it and everything older go.
+	void FinishTarget( unsigned int index )
+	{
+		TCrossFadeTarget<CLIP> &target = mTargets[index];
+		mClip = target.mClip;
+		mTime = target.mTime;
+		unsigned int pose = target.mPose;
+		target.mPose = mPose;
+		mPose = pose;
+		mHold = false;
+		ReleaseTargets( index + 1 );
+	}
+
+	// Folds the oldest target into the current pose at its present weight
+	// and holds the result; the target's slot goes back to the free list.
+	void MergeOldestTarget()
+	{
+		TCrossFadeTarget<CLIP> &target = mTargets[0];
+		float t = target.mElapsed / target.mDuration;
+		Pose &pose = mPosePool[mPose];
+		blend( pose,mPosePool[target.mPose],t > 1.0f ? 1.0f : t,pose );
+		mClip = target.mClip;
+		mTime = target.mTime;
+		mHold = true;
+		ReleaseTargets( 1 );
+	}
+public:
+	// capacity is the most fades kept in flight at once.
+	explicit TCrossFadeController( unsigned int capacity = CROSSFADE_DEFAULT_CAPACITY )
+		:
+		mSkeleton( nullptr ),
+		mClip( nullptr ),
+		mTime( 0.0f ),
+		mPose( 0 ),
+		mCapacity( capacity > 0 ? capacity : 1 ),
+		mHold( false )
+	{}
+	explicit TCrossFadeController( const Skeleton &skeleton,unsigned int capacity = CROSSFADE_DEFAULT_CAPACITY )
+		: TCrossFadeController( capacity )
+	{
+		SetSkeleton( skeleton );
+	}
+
+	// The only call that allocates. The skeleton must outlive the controller.
+	void SetSkeleton( const Skeleton &skeleton )
+	{
+		mSkeleton = &skeleton;
+		mPosePool.assign( mCapacity + 1,skeleton.GetRestPose() );
+		mOutput = skeleton.GetRestPose();
+		mTargets.clear();
+		mTargets.reserve( mCapacity );
+		mFreePoses.clear();
+		mFreePoses.reserve( mCapacity + 1 );
+		for ( unsigned int i = mCapacity; i > 0; --i )
+		{
+			mFreePoses.push_back( i );
+		}
+		mPose = 0;
+		mHold = false;
+	}
+
+	void Play( const CLIP *target )
+	{
+		ReleaseTargets( (unsigned int)mTargets.size() );
+		mClip = target;
+		mTime = target ? target->GetStartTime() : 0.0f;
+		mHold = false;
+		if ( mSkeleton )
+		{
+			mPosePool[mPose] = mSkeleton->GetRestPose();
+			mOutput = mPosePool[mPose];
+		}
+	}
+
+	void FadeTo( const CLIP *target,float fadeTime )
+	{
+		if ( mClip == nullptr || fadeTime <= 0.0f )
+		{
+			Play( target );
+			return;
+		}
+		const CLIP *last = mTargets.empty() ? mClip : mTargets.back().mClip;
+		if ( last == target || mSkeleton == nullptr )
+		{
+			return;
+		}
+		if ( mFreePoses.empty() )
+		{
+			MergeOldestTarget();
+		}
+		TCrossFadeTarget<CLIP> fade;
+		fade.mClip = target;
+		fade.mTime = target->GetStartTime();
+		fade.mDuration = fadeTime;
+		fade.mElapsed = 0.0f;
+		fade.mPose = mFreePoses.back();
+		mFreePoses.pop_back();
+		mTargets.push_back( fade );
+	}
+
+	void Update( float dt )
+	{
+		if ( mClip == nullptr || mSkeleton == nullptr )
+		{
+			return;
+		}
+		// The newest finished target hides everything before it.
+		for ( unsigned int i = (unsigned int)mTargets.size(); i > 0; --i )
+		{
+			if ( mTargets[i - 1].mElapsed >= mTargets[i - 1].mDuration )
+			{
+				FinishTarget( i - 1 );
+				break;
+			}
+		}
+		const Pose &rest = mSkeleton->GetRestPose();
+		if ( !mHold )
+		{
+			Pose &current = mPosePool[mPose];
+			current = rest;
+			mTime = mClip->Sample( current,mTime + dt );
+		}
+		Pose &pose = mOutput;
+		pose = mPosePool[mPose];
+		for ( size_t i = 0; i < mTargets.size(); ++i )
+		{
+			TCrossFadeTarget<CLIP> &target = mTargets[i];
+			Pose &targetPose = mPosePool[target.mPose];
+			targetPose = rest;
+			target.mTime = target.mClip->Sample( targetPose,target.mTime + dt );
+			target.mElapsed += dt;
+			float t = target.mElapsed / target.mDuration;
+			blend( pose,targetPose,t > 1.0f ? 1.0f : t,pose );
+		}
+	}
+
+	const Pose& GetCurrentPose() const { return mOutput; }
+	const CLIP* GetCurrentClip() const { return mClip; }
+	float GetCurrentTime() const { return mTime; }
+	unsigned int GetFadeCount() const { return (unsigned int)mTargets.size(); }
+	unsigned int GetCapacity() const { return mCapacity; }
+};
+
+typedef TCrossFadeController<Clip> CrossFadeController;
+typedef TCrossFadeController<FastClip> FastCrossFadeController;
@@ -0,0 +1,124 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdlib.h>
+#include "Benchmark.h"
+#include "PoseBenchmark.h"
+#include "CrowdSampler.h"
+
+// Crowd sampling throughput in instances per second: every instance sampling
+// its own clip against CrowdSampler's shared samples, on clips with a key
+// per joint every 1 / fps seconds.
+
+inline void fillBenchmarkSkeleton( Skeleton &skeleton,unsigned int joints )
+{
+	Pose rest;
+	fillBenchmarkPose( rest,joints );
+	skeleton = Skeleton( rest,rest,std::vector<std::string>( joints,"joint" ) );
+}
+
+inline float crowdRandom()
+{
+	return float( rand() ) / float( RAND_MAX ) * 2.0f - 1.0f;
+}
+
+// Smooth random motion: each joint swings about its own axis, the root also moves.
+inline void fillBenchmarkClip( Clip &clip,unsigned int joints,float duration,float fps )
+{
+	unsigned int keys = (unsigned int)(duration * fps) + 1;
+	for ( unsigned int j = 0; j < joints; ++j )
+	{
+		TransformTrack &track = clip[j];
+		vec3 axis = normalized( vec3( crowdRandom(),crowdRandom(),crowdRandom() ) + vec3( 0,0,0.1f ) );
+		float phase = crowdRandom() * 3.0f;
+		QuaternionTrack &rotation = track.GetRotationTrack();
+		rotation.Resize( keys );
+		for ( unsigned int k = 0; k < keys; ++k )
+		{
+			float t = float( k ) / fps;
+			quat q = angleAxis( sinf( t * 6.2831853f / duration + phase ),axis );
+			rotation[k].mTime = t;
+			for ( int c = 0; c < 4; ++c )
+			{
+				rotation[k].mValue[c] = q.v[c];
+			}
+		}
+		if ( j == 0 )
+		{
+			VectorTrack &position = track.GetPositionTrack();
+			position.Resize( keys );
+			for ( unsigned int k = 0; k < keys; ++k )
+			{
+				float t = float( k ) / fps;
+				position[k].mTime = t;
+				position[k].mValue[0] = sinf( t * 6.2831853f / duration );
+				position[k].mValue[1] = 1.0f;
+				position[k].mValue[2] = cosf( t * 6.2831853f / duration );
+			}
+		}
+	}
+	clip.RecalculateDuration();
+}
+
+inline void benchmarkCrowdSampling( unsigned int instances = 5000,unsigned int clipCount = 20,
+	unsigned int joints = 40,unsigned int frames = 20 )
+{
+	srand( 2024 );
+	Skeleton skeleton;
+	fillBenchmarkSkeleton( skeleton,joints );
+	std::vector<Clip> clips( clipCount );
+	for ( unsigned int i = 0; i < clipCount; ++i )
+	{
+		fillBenchmarkClip( clips[i],joints,1.0f + float( i % 4 ) * 0.25f,30.0f );
+	}
+	std::vector<const Clip*> instanceClips( instances );
+	std::vector<float> times( instances );
+	for ( unsigned int i = 0; i < instances; ++i )
+	{
+		instanceClips[i] = &clips[rand() % clipCount];
+		times[i] = float( rand() ) / float( RAND_MAX ) * 2.0f;
+	}
+	double items = double( instances ) * frames;
+	float dt = 1.0f / 60.0f;
+
+	// Baseline: one pose and one palette per instance.
+	std::vector<Pose> poses( instances,skeleton.GetRestPose() );
+	std::vector<mat3x4> palettes( (size_t)instances * joints );
+	BenchmarkResult single = runBenchmark( "crowd per instance",items,[&]()
+	{
+		for ( unsigned int f = 0; f < frames; ++f )
+		{
+			for ( unsigned int i = 0; i < instances; ++i )
+			{
+				poses[i] = skeleton.GetRestPose();
+				instanceClips[i]->Sample( poses[i],times[i] + f * dt );
+				skeleton.GetMatrixPalette( poses[i],palettes.data() + (size_t)i * joints );
+			}
+		}
+		benchmarkSink() = palettes[palettes.size() / 2].v[3];
+	} );
+	printBenchmark( single,"instances" );
+
+	const float tolerances[] = { 0.0f,1.0f / 60.0f,1.0f / 30.0f,1.0f / 15.0f };
+	const char *names[] = { "crowd shared, exact","crowd shared, 1/60 s","crowd shared, 1/30 s","crowd shared, 1/15 s" };
+	std::vector<float> frameTimes( instances );
+	for ( int n = 0; n < 4; ++n )
+	{
+		CrowdSampler sampler( skeleton,tolerances[n] );
+		BenchmarkResult r = runBenchmark( names[n],items,[&]()
+		{
+			for ( unsigned int f = 0; f < frames; ++f )
+			{
+				for ( unsigned int i = 0; i < instances; ++i )
+				{
+					frameTimes[i] = times[i] + f * dt;
+				}
+				sampler.Update( instanceClips.data(),frameTimes.data(),instances );
+			}
+			benchmarkSink() = sampler.GetPalette( instances / 2 )[joints / 2].v[3];
+		} );
+		printBenchmark( r,"instances" );
+		std::cout << "  " << sampler.GetGroupCount() << " groups, "
+			<< r.ItemsPerSecond() / single.ItemsPerSecond() << "x\n";
+	}
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <string.h>
+#include <stdint.h>
+#include "Clip.h"
+#include "Skeleton.h"
+
+// Default time quantization: instances within a 30 Hz frame of each other
+// on the same clip share one sample.
+#define CROWD_DEFAULT_TOLERANCE (1.0f / 30.0f)
+
+// Samples many instances of a few clips by grouping them on (clip, time
+// rounded to the tolerance). Each group is sampled once and every instance
+// of the group reads the same pose and palette. Buffers only grow, so once
+// the group count has peaked Update no longer allocates.
+template<typename CLIP>
+class TCrowdSampler
+{
+protected:
+	struct Key
+	{
+		const CLIP *clip;
+		int32_t slot;
+		uint32_t instance;
+		bool operator<( const Key &other ) const
+		{
+			if ( clip != other.clip )
+			{
+				return std::less<const CLIP*>()( clip,other.clip );
+			}
+			return slot < other.slot;
+		}
+	};
+	std::vector<Key> mKeys;
+	std::vector<uint32_t> mInstanceGroup;
+	std::vector<Pose> mPoses;
+	std::vector<mat3x4> mPalettes;
+	const Skeleton *mSkeleton;
+	float mTolerance;
+	unsigned int mGroups;
+	bool mPalettesValid;
+
+	// Slot of a time on a clip and the time that slot is sampled at. With no
+	// tolerance the slot is the adjusted time's bit pattern, so only exactly
+	// equal times share.
+	int32_t Quantize( const CLIP *clip,float time,float &sampleTime ) const
+	{
+		if ( clip == nullptr )
+		{
+			sampleTime = 0.0f;
+			return 0;
+		}
+		float t = clip->AdjustTimeToFitRange( time );
+		int32_t slot;
+		if ( mTolerance <= 0.0f )
+		{
+			memcpy( &slot,&t,sizeof( slot ) );
+			sampleTime = t;
+			return slot;
+		}
+		slot = (int32_t)((t - clip->GetStartTime()) / mTolerance + 0.5f);
+		sampleTime = clip->GetStartTime() + float( slot ) * mTolerance;
+		sampleTime = sampleTime > clip->GetEndTime() ? clip->GetEndTime() : sampleTime;
+		return slot;
+	}
+public:
+	explicit TCrowdSampler( float tolerance = CROWD_DEFAULT_TOLERANCE )
+		: mSkeleton( nullptr ),mTolerance( tolerance ),mGroups( 0 ),mPalettesValid( false )
+	{}
+	explicit TCrowdSampler( const Skeleton &skeleton,float tolerance = CROWD_DEFAULT_TOLERANCE )
+		: TCrowdSampler( tolerance )
+	{
+		SetSkeleton( skeleton );
+	}
+
+	// The skeleton must outlive the sampler.
+	void SetSkeleton( const Skeleton &skeleton )
+	{
+		mSkeleton = &skeleton;
+		mPoses.clear();
+		mPalettes.clear();
+		mGroups = 0;
+		mPalettesValid = false;
+	}
+
+	// Largest time difference, in seconds, at which two instances of a clip
+	// may share a sample; 0 shares exactly equal times only.
+	void SetTolerance( float tolerance ) { mTolerance = tolerance; }
+	float GetTolerance() const { return mTolerance; }
+
+	// Samples instance i's clips[i] at times[i]; a null clip gives the rest
+	// pose. With palettes set, each group also gets a skinning palette.
+	void Update( const CLIP *const *clips,const float *times,unsigned int count,bool palettes = true )
+	{
+		if ( mSkeleton == nullptr )
+		{
+			return;
+		}
+		mKeys.resize( count );
+		mInstanceGroup.resize( count );
+		float unused;
+		for ( unsigned int i = 0; i < count; ++i )
+		{
+			mKeys[i].clip = clips[i];
+			mKeys[i].slot = Quantize( clips[i],times[i],unused );
+			mKeys[i].instance = i;
+		}
+		std::sort( mKeys.begin(),mKeys.end() );
+
+		const Pose &rest = mSkeleton->GetRestPose();
+		unsigned int joints = rest.Size();
+		mGroups = 0;
+		for ( unsigned int i = 0; i < count; ++i )
+		{
+			const Key &key = mKeys[i];
+			if ( i == 0 || mKeys[i - 1] < key )
+			{
+				if ( mGroups == mPoses.size() )
+				{
+					mPoses.push_back( rest );
+				}
+				else
+				{
+					mPoses[mGroups] = rest;
+				}
+				if ( key.clip != nullptr )
+				{
+					float sampleTime;
+					Quantize( key.clip,times[key.instance],sampleTime );
+					key.clip->Sample( mPoses[mGroups],sampleTime );
+				}
+				++mGroups;
+			}
+			mInstanceGroup[key.instance] = mGroups - 1;
+		}
+
+		mPalettesValid = palettes;
+		if ( palettes )
+		{
+			if ( mPalettes.size() < (size_t)mGroups * joints )
+			{
+				mPalettes.resize( (size_t)mGroups * joints );
+			}
+			for ( unsigned int g = 0; g < mGroups; ++g )
+			{
+				mSkeleton->GetMatrixPalette( mPoses[g],mPalettes.data() + (size_t)g * joints );
+			}
+		}
+	}
+
+	unsigned int GetGroupCount() const { return mGroups; }
+	unsigned int GetInstanceCount() const { return (unsigned int)mInstanceGroup.size(); }
+	unsigned int GetGroup( unsigned int instance ) const { return mInstanceGroup[instance]; }
+	const Pose& GetGroupPose( unsigned int group ) const { return mPoses[group]; }
+	const Pose& GetPose( unsigned int instance ) const { return mPoses[mInstanceGroup[instance]]; }
+
+	// Null unless the last Update built palettes. Shared: do not write.
+	const mat3x4* GetGroupPalette( unsigned int group ) const
+	{
+		return mPalettesValid ? mPalettes.data() + (size_t)group * mSkeleton->GetRestPose().Size() : nullptr;
+	}
+	const mat3x4* GetPalette( unsigned int instance ) const { return GetGroupPalette( mInstanceGroup[instance] ); }
+};
+
+typedef TCrowdSampler<Clip> CrowdSampler;
+typedef TCrowdSampler<FastClip> FastCrowdSampler;
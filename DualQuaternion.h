@@ -0,0 +1,141 @@
+#pragma once
+#include <stdint.h>
+#include "quat.h"
+#include "Transform.h"
+
+// Rigid transform as a real (rotation) and a dual (half translation times
+// rotation) quaternion. Scale is not representable. Products follow quat.h:
+// a * b applies a first, then b.
+struct DualQuaternion
+{
+	union
+	{
+		struct
+		{
+			quat real;
+			quat dual;
+		};
+		float v[8];
+	};
+	constexpr DualQuaternion()
+		:
+		v{ 0,0,0,1,0,0,0,0 }
+	{};
+	constexpr DualQuaternion( const quat &r,const quat &d )
+		:
+		v{ r.v[0],r.v[1],r.v[2],r.v[3],d.v[0],d.v[1],d.v[2],d.v[3] }
+	{};
+};
+
+constexpr quat realPart( const DualQuaternion &dq )
+{
+	return quat( dq.v[0],dq.v[1],dq.v[2],dq.v[3] );
+}
+
+constexpr quat dualPart( const DualQuaternion &dq )
+{
+	return quat( dq.v[4],dq.v[5],dq.v[6],dq.v[7] );
+}
+
+// Rotation r followed by translation t.
+constexpr DualQuaternion dualQuat( const quat &r,const vec3 &t )
+{
+	return DualQuaternion( r,r * quat( t,0.0f ) * 0.5f );
+}
+
+constexpr DualQuaternion operator+( const DualQuaternion &a,const DualQuaternion &b )
+{
+	return DualQuaternion( realPart( a ) + realPart( b ),dualPart( a ) + dualPart( b ) );
+}
+
+constexpr DualQuaternion operator*( const DualQuaternion &dq,float f )
+{
+	return DualQuaternion( realPart( dq ) * f,dualPart( dq ) * f );
+}
+
+constexpr DualQuaternion operator*( const DualQuaternion &a,const DualQuaternion &b )
+{
+	return DualQuaternion(
+		realPart( a ) * realPart( b ),
+		realPart( a ) * dualPart( b ) + dualPart( a ) * realPart( b ) );
+}
+
+constexpr bool operator==( const DualQuaternion &a,const DualQuaternion &b )
+{
+	return realPart( a ) == realPart( b ) && dualPart( a ) == dualPart( b );
+}
+
+constexpr bool operator!=( const DualQuaternion &a,const DualQuaternion &b )
+{
+	return !(a == b);
+}
+
+// Only the real parts, which is what blending and the sign test need.
+constexpr float dot( const DualQuaternion &a,const DualQuaternion &b )
+{
+	return dot( realPart( a ),realPart( b ) );
+}
+
+// Antipodality correction for blending a palette: flips each dual quaternion
+// onto the hemisphere of its parent's, or of palette[0] for roots and when
+// parents is null. Parents must come before their children. Flipping keeps
+// every transform, and joints that share vertices are neighbors in the
+// hierarchy, so their blends no longer need a per vertex sign test.
+inline void alignHemispheres( DualQuaternion *palette,unsigned int count,const int16_t *parents = nullptr )
+{
+	for ( unsigned int i = 1; i < count; ++i )
+	{
+		int parent = parents && parents[i] >= 0 ? parents[i] : 0;
+		if ( dot( palette[i],palette[parent] ) < 0.0f )
+		{
+			palette[i] = palette[i] * -1.0f;
+		}
+	}
+}
+
+constexpr DualQuaternion conjugate( const DualQuaternion &dq )
+{
+	return DualQuaternion( conjugate( realPart( dq ) ),conjugate( dualPart( dq ) ) );
+}
+
+inline DualQuaternion normalized( const DualQuaternion &dq )
+{
+	float l = lenSq( realPart( dq ) );
+	if ( l < QUAT_EPSILON )
+	{
+		return DualQuaternion();
+	}
+	return dq * (1.0f / sqrtf( l ));
+}
+
+inline void normalize( DualQuaternion &dq )
+{
+	dq = normalized( dq );
+}
+
+constexpr vec3 getTranslation( const DualQuaternion &dq )
+{
+	return vectorPart( conjugate( realPart( dq ) ) * (dualPart( dq ) * 2.0f) );
+}
+
+// dq must be normalized.
+constexpr vec3 transformVector( const DualQuaternion &dq,const vec3 &v )
+{
+	return realPart( dq ) * v;
+}
+
+constexpr vec3 transformPoint( const DualQuaternion &dq,const vec3 &v )
+{
+	return realPart( dq ) * v + getTranslation( dq );
+}
+
+// Scale is dropped.
+inline DualQuaternion transformToDualQuat( const Transform &t )
+{
+	return dualQuat( t.rotation,t.position );
+}
+
+inline Transform dualQuatToTransform( const DualQuaternion &dq )
+{
+	return Transform( getTranslation( dq ),realPart( dq ),vec3( 1,1,1 ) );
+}
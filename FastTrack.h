@@ -0,0 +1,114 @@
+#pragma once
+#include <vector>
+#include <stdint.h>
+#include "Track.h"
+
+// Track with an O(1) key lookup: at load time every 1 / rate seconds of the
+// track is mapped to the key index in effect at that time. Sampling reads the
+// bucket and, if the table is coarser than the keys, steps forward the few
+// keys that fall inside the bucket. The rate is the memory / speed knob:
+// rates at or above the key rate make the lookup a single table load.
+template<typename T,int N>
+class FastTrack : public Track<T,N>
+{
+protected:
+	std::vector<uint16_t> mSampledFrames16;
+	std::vector<uint32_t> mSampledFrames32;
+	float mSampleRate;
+	float mStartTime;
+public:
+	FastTrack() : mSampleRate( 0.0f ),mStartTime( 0.0f ) {}
+	explicit FastTrack( const Track<T,N> &track,float samplesPerSecond = 60.0f )
+		: Track<T,N>( track ),mSampleRate( 0.0f ),mStartTime( 0.0f )
+	{
+		UpdateIndexLookupTable( samplesPerSecond );
+	}
+
+	// Must be called again whenever the frames change.
+	void UpdateIndexLookupTable( float samplesPerSecond = 60.0f )
+	{
+		mSampledFrames16.clear();
+		mSampledFrames32.clear();
+		mSampleRate = samplesPerSecond;
+		mStartTime = this->GetStartTime();
+		if ( this->Size() <= 1 || samplesPerSecond <= 0.0f )
+		{
+			return;
+		}
+		float duration = this->GetEndTime() - mStartTime;
+		unsigned int numSamples = (unsigned int)(duration * samplesPerSecond) + 1;
+		bool narrow = this->Size() <= 0xFFFF;
+		if ( narrow )
+		{
+			mSampledFrames16.resize( numSamples );
+		}
+		else
+		{
+			mSampledFrames32.resize( numSamples );
+		}
+		for ( unsigned int i = 0; i < numSamples; ++i )
+		{
+			int frame = Track<T,N>::FrameIndex( mStartTime + float( i ) / samplesPerSecond );
+			if ( narrow )
+			{
+				mSampledFrames16[i] = (uint16_t)frame;
+			}
+			else
+			{
+				mSampledFrames32[i] = (uint32_t)frame;
+			}
+		}
+	}
+
+	float GetSampleRate() const { return mSampleRate; }
+	size_t GetLookupTableBytes() const
+	{
+		return mSampledFrames16.size() * sizeof( uint16_t ) + mSampledFrames32.size() * sizeof( uint32_t );
+	}
+
+	int FrameIndex( float time ) const
+	{
+		size_t count = mSampledFrames16.size() + mSampledFrames32.size();
+		if ( count == 0 )
+		{
+			return Track<T,N>::FrameIndex( time );
+		}
+		float offset = (time - mStartTime) * mSampleRate;
+		size_t bucket = offset <= 0.0f ? 0 : (size_t)offset;
+		if ( bucket >= count )
+		{
+			bucket = count - 1;
+		}
+		int frame = mSampledFrames16.empty() ? (int)mSampledFrames32[bucket] : (int)mSampledFrames16[bucket];
+		int last = (int)this->mFrames.size() - 2;
+		while ( frame > 0 && this->mFrames[frame].mTime > time )
+		{
+			--frame; // bucket edge rounded past a key
+		}
+		while ( frame < last && this->mFrames[frame + 1].mTime <= time )
+		{
+			++frame;
+		}
+		return frame;
+	}
+
+	T Sample( float time,bool looping ) const
+	{
+		if ( this->mFrames.empty() )
+		{
+			return T();
+		}
+		float t = this->AdjustTimeToFitTrack( time,looping );
+		return this->SampleSegment( FrameIndex( t ),t );
+	}
+};
+
+typedef FastTrack<float,1> FastScalarTrack;
+typedef FastTrack<vec3,3> FastVectorTrack;
+typedef FastTrack<quat,4> FastQuaternionTrack;
+
+template<typename T,int N>
+FastTrack<T,N> OptimizeTrack( const Track<T,N> &input,float samplesPerSecond = 60.0f )
+{
+	return FastTrack<T,N>( input,samplesPerSecond );
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// One key of an N component track. mIn/mOut are the incoming and outgoing
+// tangents used by cubic interpolation, in value units per second.
+template<unsigned int N>
+class Frame
+{
+public:
+	float mValue[N];
+	float mIn[N];
+	float mOut[N];
+	float mTime;
+};
+
+typedef Frame<1> ScalarFrame;
+typedef Frame<3> VectorFrame;
+typedef Frame<4> QuaternionFrame;
@@ -0,0 +1,231 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include "Clip.h"
+#include "Skeleton.h"
+
+// Inertialization (Bollo, GDC 2018): at a transition the offset between the
+// outgoing pose and the first pose of the new clip is recorded once, then
+// decayed to zero by a quintic that starts with the offset's own velocity
+// and ends with zero velocity and acceleration. Only the new clip is sampled
+// from then on, where a crossfade keeps sampling both.
+
+// Scalar offset decay x( t ) for t in [0, t1], zero afterwards.
+struct InertialDecay
+{
+	float c[6];
+	float t1;
+
+	InertialDecay() : c{ 0,0,0,0,0,0 },t1( 0.0f ) {}
+
+	// x0 >= 0. An offset moving away from 0 starts at rest instead; one
+	// moving towards it shortens t1 so the curve does not overshoot.
+	void Init( float x0,float v0,float duration )
+	{
+		if ( x0 <= 0.0f || duration <= 0.0f )
+		{
+			*this = InertialDecay();
+			return;
+		}
+		v0 = v0 > 0.0f ? 0.0f : v0;
+		t1 = duration;
+		if ( v0 < 0.0f && -5.0f * x0 / v0 < t1 )
+		{
+			t1 = -5.0f * x0 / v0;
+		}
+		float tt = t1 * t1;
+		float a0 = (-8.0f * v0 * t1 - 20.0f * x0) / tt;
+		a0 = a0 < 0.0f ? 0.0f : a0;
+		c[0] = x0;
+		c[1] = v0;
+		c[2] = a0 * 0.5f;
+		c[3] = -(3.0f * a0 * tt + 12.0f * v0 * t1 + 20.0f * x0) / (2.0f * tt * t1);
+		c[4] = (3.0f * a0 * tt + 16.0f * v0 * t1 + 30.0f * x0) / (2.0f * tt * tt);
+		c[5] = -(a0 * tt + 6.0f * v0 * t1 + 12.0f * x0) / (2.0f * tt * tt * t1);
+	}
+
+	float Evaluate( float t ) const
+	{
+		if ( t >= t1 )
+		{
+			return 0.0f;
+		}
+		return ((((c[5] * t + c[4]) * t + c[3]) * t + c[2]) * t + c[1]) * t + c[0];
+	}
+};
+
+// A vec3 offset decays along its direction at transition time; the
+// previous frame's offset, projected on that direction, gives the velocity.
+struct InertialChannel
+{
+	vec3 axis;
+	InertialDecay decay;
+
+	void Init( const vec3 &offset,const vec3 &prevOffset,float dt,float duration )
+	{
+		float x0 = sqrtf( dot( offset,offset ) );
+		if ( x0 < VEC3_EPSILON )
+		{
+			axis = vec3( 0,0,0 );
+			decay = InertialDecay();
+			return;
+		}
+		axis = offset * (1.0f / x0);
+		float v0 = dt > 0.0f ? (x0 - dot( prevOffset,axis )) / dt : 0.0f;
+		decay.Init( x0,v0,duration );
+	}
+
+	vec3 Evaluate( float t ) const { return axis * decay.Evaluate( t ); }
+};
+
+// Short arc offset that takes target to source: offset * target = source.
+inline quat inertialRotationOffset( const quat &source,const quat &target )
+{
+	quat offset = source * conjugate( target );
+	return offset.v[3] < 0.0f ? -offset : offset;
+}
+
+// Per joint position, rotation (in quat log space) and scale offsets.
+class Inertializer
+{
+protected:
+	struct Joint
+	{
+		InertialChannel position;
+		InertialChannel rotation;
+		InertialChannel scale;
+	};
+	std::vector<Joint> mJoints;
+	float mElapsed;
+	float mDuration;
+public:
+	Inertializer() : mElapsed( 0.0f ),mDuration( 0.0f ) {}
+
+	void Resize( unsigned int joints ) { mJoints.resize( joints ); }
+	bool IsActive() const { return mElapsed < mDuration; }
+
+	// prev and source are the last two output poses, dt the time between
+	// them; target is the new clip at its start. All must be Resize()'d sized.
+	void Begin( const Pose &prev,const Pose &source,const Pose &target,float dt,float duration )
+	{
+		const Transform *p = prev.GetLocalTransforms();
+		const Transform *s = source.GetLocalTransforms();
+		const Transform *t = target.GetLocalTransforms();
+		mDuration = 0.0f;
+		for ( size_t i = 0; i < mJoints.size(); ++i )
+		{
+			Joint &j = mJoints[i];
+			j.position.Init( s[i].position - t[i].position,p[i].position - t[i].position,dt,duration );
+			j.rotation.Init( quatLog( inertialRotationOffset( s[i].rotation,t[i].rotation ) ),
+				quatLog( inertialRotationOffset( p[i].rotation,t[i].rotation ) ),dt,duration );
+			j.scale.Init( s[i].scale - t[i].scale,p[i].scale - t[i].scale,dt,duration );
+			float longest = j.position.decay.t1 > j.rotation.decay.t1 ? j.position.decay.t1 : j.rotation.decay.t1;
+			longest = j.scale.decay.t1 > longest ? j.scale.decay.t1 : longest;
+			mDuration = longest > mDuration ? longest : mDuration;
+		}
+		mElapsed = 0.0f;
+	}
+
+	// Advances by dt and adds the remaining offsets onto the freshly sampled pose.
+	void Apply( Pose &pose,float dt )
+	{
+		if ( !IsActive() )
+		{
+			return;
+		}
+		mElapsed += dt;
+		if ( !IsActive() )
+		{
+			return;
+		}
+		Transform *local = pose.GetLocalTransforms();
+		for ( size_t i = 0; i < mJoints.size(); ++i )
+		{
+			const Joint &j = mJoints[i];
+			local[i].position = local[i].position + j.position.Evaluate( mElapsed );
+			local[i].rotation = quatExp( j.rotation.Evaluate( mElapsed ) ) * local[i].rotation;
+			local[i].scale = local[i].scale + j.scale.Evaluate( mElapsed );
+		}
+	}
+};
+
+// Clip player that transitions by inertialization. Like the crossfade
+// controller, it allocates only in SetSkeleton.
+template<typename CLIP>
+class TInertializationController
+{
+protected:
+	Inertializer mInertializer;
+	Pose mPose;
+	Pose mPrevPose;
+	Pose mTargetPose;
+	const Skeleton *mSkeleton;
+	const CLIP *mClip;
+	float mTime;
+	float mLastDt;
+public:
+	TInertializationController() : mSkeleton( nullptr ),mClip( nullptr ),mTime( 0.0f ),mLastDt( 0.0f ) {}
+	explicit TInertializationController( const Skeleton &skeleton ) : TInertializationController()
+	{
+		SetSkeleton( skeleton );
+	}
+
+	// The skeleton must outlive the controller.
+	void SetSkeleton( const Skeleton &skeleton )
+	{
+		mSkeleton = &skeleton;
+		mPose = skeleton.GetRestPose();
+		mPrevPose = mPose;
+		mTargetPose = mPose;
+		mInertializer = Inertializer();
+		mInertializer.Resize( mPose.Size() );
+		mLastDt = 0.0f;
+	}
+
+	void Play( const CLIP *target )
+	{
+		mClip = target;
+		mTime = target ? target->GetStartTime() : 0.0f;
+		mInertializer.Begin( mPose,mPose,mPose,0.0f,0.0f );
+	}
+
+	// Starts target from its beginning, easing out of whatever is showing now,
+	// including another transition still in progress.
+	void InertializeTo( const CLIP *target,float duration )
+	{
+		if ( mClip == nullptr || mSkeleton == nullptr || duration <= 0.0f )
+		{
+			Play( target );
+			return;
+		}
+		if ( target == mClip )
+		{
+			return;
+		}
+		mClip = target;
+		mTargetPose = mSkeleton->GetRestPose();
+		mTime = target->Sample( mTargetPose,target->GetStartTime() );
+		mInertializer.Begin( mPrevPose,mPose,mTargetPose,mLastDt,duration );
+	}
+
+	void Update( float dt )
+	{
+		if ( mClip == nullptr || mSkeleton == nullptr )
+		{
+			return;
+		}
+		std::swap( mPose,mPrevPose );
+		mPose = mSkeleton->GetRestPose();
+		mTime = mClip->Sample( mPose,mTime + dt );
+		mInertializer.Apply( mPose,dt );
+		mLastDt = dt;
+	}
+
+	const Pose& GetCurrentPose() const { return mPose; }
+	const CLIP* GetCurrentClip() const { return mClip; }
+	float GetCurrentTime() const { return mTime; }
+	bool IsTransitioning() const { return mInertializer.IsActive(); }
+};
+
+typedef TInertializationController<Clip> InertializationController;
+typedef TInertializationController<FastClip> FastInertializationController;
@@ -0,0 +1,165 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <math.h>
+#include <string.h>
+#include "Clip.h"
+#include "PoseSoA.h"
+
+// Clip resampled at a fixed rate and stored time-major: frame f is one
+// block holding every joint's keys for that time as ten component streams
+// (px, py, pz, rx, ry, rz, rw, sx, sy, sz), each PoseSoA::PaddedSize() long.
+// Sampling a whole pose reads blocks f and f + 1, which are adjacent, so the
+// read is one contiguous forward stream the prefetcher follows, instead of
+// one region per channel. The streams decode straight into a PoseSoA with
+// the same branch free lerp / nlerp loops PoseSoA.h uses for blending.
+// Rotations are flipped onto the previous frame's hemisphere while baking,
+// so the nlerp needs no sign test.
+class InterleavedClip
+{
+protected:
+	std::vector<float> mKeys;
+	std::string mName;
+	unsigned int mJoints;
+	unsigned int mPadded;
+	unsigned int mFrames;
+	float mSampleRate;
+	float mStartTime;
+	float mEndTime;
+	bool mLooping;
+
+	static const unsigned int kStreams = 10;
+
+	float* Block( unsigned int frame ) { return mKeys.data() + (size_t)frame * kStreams * mPadded; }
+	const float* Block( unsigned int frame ) const { return mKeys.data() + (size_t)frame * kStreams * mPadded; }
+public:
+	InterleavedClip()
+		:
+		mJoints( 0 ),
+		mPadded( 0 ),
+		mFrames( 0 ),
+		mSampleRate( 0.0f ),
+		mStartTime( 0.0f ),
+		mEndTime( 0.0f ),
+		mLooping( true )
+	{}
+
+	// Samples clip on rest at evenly spaced frames from its start through its
+	// end, at least sampleRate per second, as bakeAnimTexture does.
+	template<typename CLIP>
+	void Build( const Pose &rest,const CLIP &clip,float sampleRate = 30.0f )
+	{
+		mName = clip.GetName();
+		mLooping = clip.GetLooping();
+		mStartTime = clip.GetStartTime();
+		mEndTime = clip.GetEndTime();
+		mJoints = rest.Size();
+		mPadded = (mJoints + POSE_SOA_WIDTH - 1) & ~(POSE_SOA_WIDTH - 1);
+		float duration = clip.GetDuration();
+		mFrames = duration > 0.0f && sampleRate > 0.0f ? (unsigned int)ceilf( duration * sampleRate ) + 1 : 1;
+		mSampleRate = mFrames > 1 ? float( mFrames - 1 ) / duration : 0.0f;
+		mKeys.assign( (size_t)mFrames * kStreams * mPadded,0.0f );
+
+		// a looping clip wraps its end time to the start pose
+		float last = clipLastSampleTime( clip );
+		Pose pose;
+		for ( unsigned int f = 0; f < mFrames; ++f )
+		{
+			float time = f + 1 < mFrames ? mStartTime + float( f ) / mSampleRate : last;
+			pose = rest;
+			clip.Sample( pose,time );
+			float *block = Block( f );
+			const float *previous = f > 0 ? Block( f - 1 ) : nullptr;
+			for ( unsigned int j = 0; j < mPadded; ++j )
+			{
+				Transform t = j < mJoints ? pose.GetLocalTransform( j ) : Transform();
+				quat r = t.rotation;
+				if ( previous )
+				{
+					float d = r.v[0] * previous[3 * mPadded + j] + r.v[1] * previous[4 * mPadded + j] +
+						r.v[2] * previous[5 * mPadded + j] + r.v[3] * previous[6 * mPadded + j];
+					r = d < 0.0f ? -r : r;
+				}
+				const float values[kStreams] = { t.position.v[0],t.position.v[1],t.position.v[2],
+					r.v[0],r.v[1],r.v[2],r.v[3],t.scale.v[0],t.scale.v[1],t.scale.v[2] };
+				for ( unsigned int s = 0; s < kStreams; ++s )
+				{
+					block[s * mPadded + j] = values[s];
+				}
+			}
+		}
+	}
+
+	// Wraps (looping) or clamps like Clip, then maps to a fractional frame.
+	float GetFrame( float time ) const
+	{
+		float duration = mEndTime - mStartTime;
+		if ( duration <= 0.0f || mFrames <= 1 )
+		{
+			return 0.0f;
+		}
+		if ( mLooping )
+		{
+			time = fmodf( time - mStartTime,duration );
+			time = (time < 0.0f ? time + duration : time) + mStartTime;
+		}
+		time = time < mStartTime ? mStartTime : (time > mEndTime ? mEndTime : time);
+		float frame = (time - mStartTime) * mSampleRate;
+		float last = float( mFrames - 1 );
+		return frame > last ? last : frame;
+	}
+
+	// out must have been Resize()'d to GetJointCount() joints (parents are
+	// left alone). Writes every joint, padding lanes included.
+	float Sample( PoseSoA &out,float time ) const
+	{
+		float frame = GetFrame( time );
+		unsigned int f0 = (unsigned int)frame;
+		unsigned int f1 = f0 + 1 < mFrames ? f0 + 1 : f0;
+		float t = frame - float( f0 );
+		const float *a = Block( f0 );
+		const float *b = Block( f1 );
+		unsigned int n = mPadded;
+		TransformSoA &o = out.GetStreams();
+		SoaWeight weight = { t };
+		soaLerp( a,b,weight,o.px.data(),0,n );
+		soaLerp( a + n,b + n,weight,o.py.data(),0,n );
+		soaLerp( a + 2 * n,b + 2 * n,weight,o.pz.data(),0,n );
+		soaLerp( a + 7 * n,b + 7 * n,weight,o.sx.data(),0,n );
+		soaLerp( a + 8 * n,b + 8 * n,weight,o.sy.data(),0,n );
+		soaLerp( a + 9 * n,b + 9 * n,weight,o.sz.data(),0,n );
+
+		const float *ax = a + 3 * n,*ay = a + 4 * n,*az = a + 5 * n,*aw = a + 6 * n;
+		const float *bx = b + 3 * n,*by = b + 4 * n,*bz = b + 5 * n,*bw = b + 6 * n;
+		float s = 1.0f - t;
+		for ( unsigned int i = 0; i < n; i += POSE_SOA_WIDTH )
+		{
+			float qx[POSE_SOA_WIDTH],qy[POSE_SOA_WIDTH],qz[POSE_SOA_WIDTH],qw[POSE_SOA_WIDTH];
+			for ( unsigned int k = 0; k < POSE_SOA_WIDTH; ++k )
+			{
+				unsigned int j = i + k;
+				float x = ax[j] * s + bx[j] * t;
+				float y = ay[j] * s + by[j] * t;
+				float z = az[j] * s + bz[j] * t;
+				float w = aw[j] * s + bw[j] * t;
+				float inv = 1.0f / sqrtf( x * x + y * y + z * z + w * w );
+				qx[k] = x * inv; qy[k] = y * inv; qz[k] = z * inv; qw[k] = w * inv;
+			}
+			memcpy( o.rx.data() + i,qx,sizeof( qx ) ); memcpy( o.ry.data() + i,qy,sizeof( qy ) );
+			memcpy( o.rz.data() + i,qz,sizeof( qz ) ); memcpy( o.rw.data() + i,qw,sizeof( qw ) );
+		}
+		return mStartTime + frame / (mSampleRate > 0.0f ? mSampleRate : 1.0f);
+	}
+
+	unsigned int GetJointCount() const { return mJoints; }
+	unsigned int GetFrameCount() const { return mFrames; }
+	float GetSampleRate() const { return mSampleRate; }
+	size_t GetBlockBytes() const { return (size_t)kStreams * mPadded * sizeof( float ); }
+	size_t GetSizeInBytes() const { return mKeys.size() * sizeof( float ); }
+	const std::string& GetName() const { return mName; }
+	float GetDuration() const { return mEndTime - mStartTime; }
+	float GetStartTime() const { return mStartTime; }
+	float GetEndTime() const { return mEndTime; }
+	bool GetLooping() const { return mLooping; }
+	void SetLooping( bool looping ) { mLooping = looping; }
+};
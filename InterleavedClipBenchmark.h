@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <stdlib.h>
+#include "Benchmark.h"
+#include "AnimTextureBenchmark.h"
+#include "InterleavedClip.h"
+
+// Whole pose sampling, per track layouts against the time-interleaved one.
+// Each sample picks a random clip out of many so the keys come from memory
+// rather than from a warm cache, as they would for a crowd.
+
+template<typename CLIP>
+BenchmarkResult benchmarkPoseSampling( const char *name,const std::vector<CLIP> &clips,const Pose &rest,
+	const std::vector<unsigned int> &picks,const std::vector<float> &times )
+{
+	Pose pose = rest;
+	return runBenchmark( name,double( times.size() ),[&]()
+	{
+		for ( size_t i = 0; i < times.size(); ++i )
+		{
+			pose = rest;
+			clips[picks[i]].Sample( pose,times[i] );
+		}
+		benchmarkSink() = pose.GetLocalTransform( 0 ).rotation.x;
+	} );
+}
+
+inline void benchmarkInterleavedClip( unsigned int joints = 60,unsigned int clipCount = 64,float duration = 4.0f,
+	unsigned int samples = 50000 )
+{
+	srand( 11 );
+	Pose rest;
+	fillBenchmarkPose( rest,joints );
+	std::vector<Clip> clips( clipCount );
+	for ( unsigned int c = 0; c < clipCount; ++c )
+	{
+		fillBenchmarkClip( clips[c],joints,duration,30.0f );
+	}
+	std::vector<FastClip> fast( clipCount );
+	std::vector<InterleavedClip> interleaved( clipCount );
+	size_t trackBytes = 0;
+	for ( unsigned int c = 0; c < clipCount; ++c )
+	{
+		fast[c] = OptimizeClip( clips[c] );
+		interleaved[c].Build( rest,clips[c],30.0f );
+		trackBytes += clipKeyBytes( clips[c] );
+	}
+	std::cout << "per track keys: " << trackBytes << " bytes, interleaved: "
+		<< interleaved[0].GetSizeInBytes() * clipCount << " bytes ("
+		<< interleaved[0].GetBlockBytes() << " per frame)\n";
+
+	std::vector<unsigned int> picks( samples );
+	std::vector<float> times( samples );
+	for ( unsigned int i = 0; i < samples; ++i )
+	{
+		picks[i] = rand() % clipCount;
+		times[i] = float( rand() ) / float( RAND_MAX ) * duration;
+	}
+	printBenchmark( benchmarkPoseSampling( "per track clip",clips,rest,picks,times ),"poses" );
+	printBenchmark( benchmarkPoseSampling( "per track fast clip",fast,rest,picks,times ),"poses" );
+
+	PoseSoA out( rest );
+	BenchmarkResult r = runBenchmark( "interleaved to soa",double( samples ),[&]()
+	{
+		for ( unsigned int i = 0; i < samples; ++i )
+		{
+			interleaved[picks[i]].Sample( out,times[i] );
+		}
+		benchmarkSink() = out.GetStreams().rx[joints / 2];
+	} );
+	printBenchmark( r,"poses" );
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+enum class Interpolation
+{
+	Constant,
+	Linear,
+	Cubic
+};
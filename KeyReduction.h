@@ -0,0 +1,225 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "Clip.h"
+
+// Tolerances are object space distances. Every joint carries virtual skin
+// vertices vertexDistance away along its local axes; a key may only go if
+// no joint or vertex below the track's joint moves further than the
+// channel's tolerance from where the original clip puts it.
+struct KeyReductionSettings
+{
+	float positionTolerance;
+	float rotationTolerance;
+	float scaleTolerance;
+	float vertexDistance;
+	KeyReductionSettings()
+		:
+		positionTolerance( 0.001f ),
+		rotationTolerance( 0.001f ),
+		scaleTolerance( 0.001f ),
+		vertexDistance( 0.03f )
+	{}
+};
+
+struct KeyReductionStats
+{
+	unsigned int keysBefore;
+	unsigned int keysAfter;
+	float maxError; // largest object space error among the accepted removals
+	float Ratio() const { return keysAfter > 0 ? float( keysBefore ) / float( keysAfter ) : 1.0f; }
+};
+
+// Greedy key removal over a whole clip. Each channel is walked front to
+// back and a key is dropped when interpolating straight across it keeps the
+// hierarchy within tolerance at every original key time and segment midpoint
+// it spans. The check samples the clip as reduced so far, so error from
+// channels already reduced (a parent's, say) counts against later ones.
+// Candidate values come from the track's own interpolation (nlerp with the
+// short arc flip for quaternions), so the error is the error the runtime
+// sees. Cubic tracks are left as they are: dropping a key would need new
+// tangents.
+class KeyframeReducer
+{
+protected:
+	KeyReductionSettings mSettings;
+	Pose mRest;
+	Clip mWork;
+	std::vector<float> mTimes;
+	std::vector<Transform> mReference;
+	std::vector<Transform> mGlobals;
+	std::vector<char> mSubtree;
+	Pose mPose;
+	float mMaxError;
+
+	float JointError( const Transform &a,const Transform &b ) const
+	{
+		float d = mSettings.vertexDistance;
+		const vec3 points[4] = { vec3( 0,0,0 ),vec3( d,0,0 ),vec3( 0,d,0 ),vec3( 0,0,d ) };
+		float error = 0.0f;
+		for ( int i = 0; i < 4; ++i )
+		{
+			vec3 delta = transformPoint( a,points[i] ) - transformPoint( b,points[i] );
+			float e = dot( delta,delta );
+			error = e > error ? e : error;
+		}
+		return sqrtf( error );
+	}
+
+	// Largest error over the test times strictly inside ( begin, end ), with
+	// candidate( local transform, time ) overriding the channel being reduced.
+	// Stops early once limit is exceeded.
+	template<typename F>
+	float SpanError( float begin,float end,unsigned int joint,float limit,F candidate )
+	{
+		unsigned int joints = mRest.Size();
+		size_t first = std::upper_bound( mTimes.begin(),mTimes.end(),begin ) - mTimes.begin();
+		float error = 0.0f;
+		for ( size_t i = first; i < mTimes.size() && mTimes[i] < end; ++i )
+		{
+			mPose = mRest;
+			mWork.Sample( mPose,mTimes[i] );
+			candidate( mPose.GetLocalTransforms()[joint],mTimes[i] );
+			mPose.GetGlobalTransforms( mGlobals.data() );
+			const Transform *reference = mReference.data() + i * joints;
+			for ( unsigned int j = joint; j < joints; ++j )
+			{
+				if ( mSubtree[j] )
+				{
+					float e = JointError( mGlobals[j],reference[j] );
+					error = e > error ? e : error;
+				}
+			}
+			if ( error > limit )
+			{
+				break;
+			}
+		}
+		return error;
+	}
+
+	template<typename T,int N,typename SET>
+	Track<T,N> ReduceTrack( const Track<T,N> &track,unsigned int joint,float tolerance,SET set,unsigned int &keysAfter )
+	{
+		unsigned int size = track.Size();
+		if ( size <= 2 || track.GetInterpolation() == Interpolation::Cubic )
+		{
+			keysAfter += size;
+			return track;
+		}
+		std::vector<unsigned int> kept;
+		kept.push_back( 0 );
+		bool constant = track.GetInterpolation() == Interpolation::Constant;
+		for ( unsigned int k = 1; k + 1 < size; ++k )
+		{
+			const Frame<N> &a = track[kept.back()];
+			const Frame<N> &b = track[k + 1];
+			T va = TTrackValue<T>::cast( a.mValue );
+			T vb = TTrackValue<T>::cast( b.mValue );
+			float delta = b.mTime - a.mTime;
+			float error = SpanError( a.mTime,b.mTime,joint,tolerance,[&]( Transform &local,float time )
+			{
+				float t = delta > 0.0f ? (time - a.mTime) / delta : 0.0f;
+				set( local,constant ? va : TTrackValue<T>::interpolate( va,vb,t ) );
+			} );
+			if ( error <= tolerance )
+			{
+				mMaxError = error > mMaxError ? error : mMaxError;
+				continue;
+			}
+			kept.push_back( k );
+		}
+		kept.push_back( size - 1 );
+
+		Track<T,N> result;
+		result.SetInterpolation( track.GetInterpolation() );
+		result.Resize( (unsigned int)kept.size() );
+		for ( size_t i = 0; i < kept.size(); ++i )
+		{
+			result[(unsigned int)i] = track[kept[i]];
+		}
+		keysAfter += (unsigned int)kept.size();
+		return result;
+	}
+
+	template<typename TRACK>
+	void AddTimes( const TRACK &track )
+	{
+		for ( unsigned int i = 0, size = track.Size(); i < size; ++i )
+		{
+			mTimes.push_back( track[i].mTime );
+			if ( i + 1 < size )
+			{
+				mTimes.push_back( (track[i].mTime + track[i + 1].mTime) * 0.5f );
+			}
+		}
+	}
+public:
+	explicit KeyframeReducer( const KeyReductionSettings &settings = KeyReductionSettings() )
+		: mSettings( settings ),mMaxError( 0.0f )
+	{}
+
+	// rest is the pose the clip is sampled into; out may not alias input.
+	KeyReductionStats Reduce( const Pose &rest,const Clip &input,Clip &out )
+	{
+		unsigned int joints = rest.Size();
+		mRest = rest;
+		mWork = input;
+		mMaxError = 0.0f;
+		mGlobals.resize( joints );
+		mSubtree.resize( joints );
+
+		// Every original key time and segment midpoint, with the original
+		// clip's global transforms at each.
+		mTimes.clear();
+		for ( unsigned int i = 0; i < input.Size(); ++i )
+		{
+			const TransformTrack &track = input.GetTrackAtIndex( i );
+			AddTimes( track.GetPositionTrack() );
+			AddTimes( track.GetRotationTrack() );
+			AddTimes( track.GetScaleTrack() );
+		}
+		std::sort( mTimes.begin(),mTimes.end() );
+		mTimes.erase( std::unique( mTimes.begin(),mTimes.end() ),mTimes.end() );
+		mReference.resize( mTimes.size() * joints );
+		for ( size_t i = 0; i < mTimes.size(); ++i )
+		{
+			mPose = rest;
+			input.Sample( mPose,mTimes[i] );
+			mPose.GetGlobalTransforms( mReference.data() + i * joints );
+		}
+
+		KeyReductionStats stats;
+		stats.keysBefore = 0;
+		stats.keysAfter = 0;
+		for ( unsigned int i = 0; i < input.Size(); ++i )
+		{
+			unsigned int joint = input.GetIdAtIndex( i );
+			for ( unsigned int j = 0; j < joints; ++j )
+			{
+				int parent = rest.GetParent( j );
+				mSubtree[j] = j == joint || (j > joint && parent >= 0 && mSubtree[parent]);
+			}
+			const TransformTrack &source = input.GetTrackAtIndex( i );
+			TransformTrack &work = mWork[joint];
+			stats.keysBefore += source.GetPositionTrack().Size() + source.GetRotationTrack().Size() + source.GetScaleTrack().Size();
+			work.GetPositionTrack() = ReduceTrack( source.GetPositionTrack(),joint,mSettings.positionTolerance,
+				[]( Transform &local,const vec3 &v ) { local.position = v; },stats.keysAfter );
+			work.GetRotationTrack() = ReduceTrack( source.GetRotationTrack(),joint,mSettings.rotationTolerance,
+				[]( Transform &local,const quat &q ) { local.rotation = q; },stats.keysAfter );
+			work.GetScaleTrack() = ReduceTrack( source.GetScaleTrack(),joint,mSettings.scaleTolerance,
+				[]( Transform &local,const vec3 &v ) { local.scale = v; },stats.keysAfter );
+		}
+		stats.maxError = mMaxError;
+		out = mWork;
+		out.RecalculateDuration();
+		return stats;
+	}
+};
+
+inline KeyReductionStats reduceKeyframes( const Pose &rest,const Clip &input,Clip &out,
+	const KeyReductionSettings &settings = KeyReductionSettings() )
+{
+	KeyframeReducer reducer( settings );
+	return reducer.Reduce( rest,input,out );
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <vector>
+#include <stdlib.h>
+#include "Benchmark.h"
+#include "CrowdBenchmark.h"
+#include "KeyReduction.h"
+
+// Key reduction on mocap-like data (a key every frame on every channel, with
+// a little sensor noise): compression ratio, object space error measured
+// densely after the fact, and clip sampling speed before and after.
+
+// Largest joint or virtual vertex displacement between two clips, sampled
+// at samples evenly spaced times.
+inline float clipObjectSpaceError( const Pose &rest,const Clip &a,const Clip &b,float vertexDistance,unsigned int samples )
+{
+	unsigned int joints = rest.Size();
+	Pose pa,pb;
+	std::vector<Transform> ga( joints ),gb( joints );
+	const vec3 points[4] = { vec3( 0,0,0 ),vec3( vertexDistance,0,0 ),vec3( 0,vertexDistance,0 ),vec3( 0,0,vertexDistance ) };
+	float error = 0.0f;
+	for ( unsigned int s = 0; s < samples; ++s )
+	{
+		float time = a.GetStartTime() + a.GetDuration() * float( s ) / float( samples );
+		pa = rest;
+		pb = rest;
+		a.Sample( pa,time );
+		b.Sample( pb,time );
+		pa.GetGlobalTransforms( ga.data() );
+		pb.GetGlobalTransforms( gb.data() );
+		for ( unsigned int j = 0; j < joints; ++j )
+		{
+			for ( int p = 0; p < 4; ++p )
+			{
+				vec3 delta = transformPoint( ga[j],points[p] ) - transformPoint( gb[j],points[p] );
+				float e = sqrtf( dot( delta,delta ) );
+				error = e > error ? e : error;
+			}
+		}
+	}
+	return error;
+}
+
+template<typename CLIP>
+BenchmarkResult benchmarkClipSampling( const char *name,const Pose &rest,const CLIP &clip,unsigned int samples )
+{
+	Pose pose = rest;
+	BenchmarkResult r = runBenchmark( name,samples,[&]()
+	{
+		for ( unsigned int i = 0; i < samples; ++i )
+		{
+			clip.Sample( pose,float( i ) * 0.00731f );
+		}
+		benchmarkSink() = pose.GetLocalTransform( 0 ).rotation.x;
+	} );
+	return r;
+}
+
+inline void benchmarkKeyReduction( unsigned int joints = 60,float duration = 4.0f,float fps = 60.0f,
+	float noise = 0.0005f,unsigned int samples = 20000 )
+{
+	srand( 31 );
+	Pose rest;
+	fillBenchmarkPose( rest,joints );
+	for ( unsigned int i = 1; i < joints; ++i )
+	{
+		rest.SetParent( i,(int)(i - 1) / 4 );
+	}
+	Clip clip;
+	fillBenchmarkClip( clip,joints,duration,fps );
+	for ( unsigned int i = 0; i < clip.Size(); ++i )
+	{
+		QuaternionTrack &rotation = clip[clip.GetIdAtIndex( i )].GetRotationTrack();
+		for ( unsigned int k = 0; k < rotation.Size(); ++k )
+		{
+			for ( int c = 0; c < 4; ++c )
+			{
+				rotation[k].mValue[c] += noise * crowdRandom();
+			}
+		}
+	}
+
+	KeyReductionSettings settings;
+	Clip reduced;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	KeyReductionStats stats = reduceKeyframes( rest,clip,reduced,settings );
+	double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+	std::cout << "keys " << stats.keysBefore << " -> " << stats.keysAfter << ", " << stats.Ratio() << ":1 in "
+		<< seconds * 1000.0 << " ms\n";
+	std::cout << "max error, at test times: " << stats.maxError << ", dense: "
+		<< clipObjectSpaceError( rest,clip,reduced,settings.vertexDistance,2000 ) << " (tolerance "
+		<< settings.rotationTolerance << ")\n";
+
+	FastClip fast = OptimizeClip( clip );
+	FastClip fastReduced = OptimizeClip( reduced );
+	printBenchmark( benchmarkClipSampling( "sample original",rest,clip,samples ),"poses" );
+	printBenchmark( benchmarkClipSampling( "sample reduced",rest,reduced,samples ),"poses" );
+	printBenchmark( benchmarkClipSampling( "sample original fast",rest,fast,samples ),"poses" );
+	printBenchmark( benchmarkClipSampling( "sample reduced fast",rest,fastReduced,samples ),"poses" );
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <vector>
+#include <stdint.h>
+#include "Track.h"
+
+#if TVEC_SSE
+#include <xmmintrin.h>
+#endif
+
+// Up to this many keys a branch-free SIMD scan over a flat time array beats
+// any tree; above it KeyTimeIndex switches to the Eytzinger layout.
+#define KEY_SEARCH_LINEAR_MAX 64
+
+// Key-time index that needs no lookup table, for long tracks where a
+// FastTrack table would be too large. Short tracks keep their times in a
+// flat, +inf padded array and are scanned four keys at a time. Long tracks
+// keep them in Eytzinger (BFS) order: the search descends an implicit
+// binary tree whose top levels share cache lines, and the line four levels
+// down is prefetched while the current one is compared.
+class KeyTimeIndex
+{
+	std::vector<float> mTimes;		// flat and padded, or 1-based Eytzinger
+	std::vector<uint32_t> mSorted;	// Eytzinger slot -> key index
+	int mKeys;
+	bool mEytzinger;
+
+	int BuildEytzinger( const std::vector<float> &sorted,int i,int k )
+	{
+		if ( k <= mKeys )
+		{
+			i = BuildEytzinger( sorted,i,2 * k );
+			mTimes[k] = sorted[i];
+			mSorted[k] = (uint32_t)i;
+			++i;
+			i = BuildEytzinger( sorted,i,2 * k + 1 );
+		}
+		return i;
+	}
+
+	static int TrailingOnes( unsigned int k )
+	{
+		int n = 0;
+		while ( k & 1u )
+		{
+			k >>= 1;
+			++n;
+		}
+		return n;
+	}
+public:
+	KeyTimeIndex() : mKeys( 0 ),mEytzinger( false ) {}
+
+	template<typename T,int N>
+	void Build( const Track<T,N> &track )
+	{
+		Build( track,track.Size() > KEY_SEARCH_LINEAR_MAX );
+	}
+
+	template<typename T,int N>
+	void Build( const Track<T,N> &track,bool eytzinger )
+	{
+		mKeys = (int)track.Size();
+		mEytzinger = eytzinger;
+		mTimes.clear();
+		mSorted.clear();
+		if ( !eytzinger )
+		{
+			mTimes.resize( (mKeys + 3) & ~3,HUGE_VALF );
+			for ( int i = 0; i < mKeys; ++i )
+			{
+				mTimes[i] = track[i].mTime;
+			}
+			return;
+		}
+		std::vector<float> sorted( mKeys );
+		for ( int i = 0; i < mKeys; ++i )
+		{
+			sorted[i] = track[i].mTime;
+		}
+		mTimes.resize( mKeys + 1 );
+		mSorted.resize( mKeys + 1 );
+		BuildEytzinger( sorted,0,1 );
+	}
+
+	bool IsEytzinger() const { return mEytzinger; }
+	size_t GetIndexBytes() const { return mTimes.size() * sizeof( float ) + mSorted.size() * sizeof( uint32_t ); }
+
+	// Same contract as Track::FrameIndex.
+	int FrameIndex( float time ) const
+	{
+		if ( mKeys <= 1 )
+		{
+			return -1;
+		}
+		int count = mEytzinger ? EytzingerCount( time ) : LinearCount( time );
+		int frame = count - 1;
+		return frame < 0 ? 0 : (frame > mKeys - 2 ? mKeys - 2 : frame);
+	}
+
+	// Number of keys with time <= t, four at a time.
+	int LinearCount( float time ) const
+	{
+		const float *times = mTimes.data();
+		int padded = (int)mTimes.size();
+		int count = 0;
+#if TVEC_SSE
+		static const int bits[16] = { 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4 };
+		__m128 t = _mm_set1_ps( time );
+		for ( int i = 0; i < padded; i += 4 )
+		{
+			count += bits[_mm_movemask_ps( _mm_cmple_ps( _mm_loadu_ps( times + i ),t ) )];
+		}
+#else
+		for ( int i = 0; i < padded; ++i )
+		{
+			count += times[i] <= time;
+		}
+#endif
+		return count;
+	}
+
+	// Sorted position of the first key with time > t, found by descending the
+	// implicit tree; the final node is recovered by undoing the trailing
+	// right turns.
+	int EytzingerCount( float time ) const
+	{
+		const float *times = mTimes.data();
+		unsigned int n = (unsigned int)mKeys;
+		unsigned int k = 1;
+		while ( k <= n )
+		{
+#if TVEC_SSE
+			unsigned int ahead = k * 16;
+			_mm_prefetch( (const char*)(times + (ahead <= n ? ahead : n)),_MM_HINT_T0 );
+#endif
+			k = 2 * k + (times[k] <= time ? 1u : 0u);
+		}
+		k >>= TrailingOnes( k ) + 1;
+		return k == 0 ? mKeys : (int)mSorted[k];
+	}
+};
+
+// Track whose key lookup goes through a KeyTimeIndex instead of a plain
+// binary search over the frames.
+template<typename T,int N>
+class IndexedTrack : public Track<T,N>
+{
+protected:
+	KeyTimeIndex mIndex;
+public:
+	IndexedTrack() {}
+	explicit IndexedTrack( const Track<T,N> &track ) : Track<T,N>( track )
+	{
+		UpdateIndex();
+	}
+	// Must be called again whenever the frames change.
+	void UpdateIndex() { mIndex.Build( *this ); }
+	const KeyTimeIndex& GetIndex() const { return mIndex; }
+
+	int FrameIndex( float time ) const { return mIndex.FrameIndex( time ); }
+
+	T Sample( float time,bool looping ) const
+	{
+		if ( this->mFrames.empty() )
+		{
+			return T();
+		}
+		float t = this->AdjustTimeToFitTrack( time,looping );
+		return this->SampleSegment( FrameIndex( t ),t );
+	}
+};
+
+typedef IndexedTrack<float,1> IndexedScalarTrack;
+typedef IndexedTrack<vec3,3> IndexedVectorTrack;
+typedef IndexedTrack<quat,4> IndexedQuaternionTrack;
@@ -0,0 +1,117 @@
+#pragma once
+#include <stddef.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file mapped into memory. Pages come from the
+// OS page cache, so every process mapping the same file shares them.
+class MappedFile
+{
+protected:
+	const void *mData;
+	size_t mSize;
+#ifdef _WIN32
+	HANDLE mFile;
+	HANDLE mMapping;
+#else
+	int mFile;
+#endif
+public:
+#ifdef _WIN32
+	MappedFile() : mData( nullptr ),mSize( 0 ),mFile( INVALID_HANDLE_VALUE ),mMapping( nullptr ) {}
+#else
+	MappedFile() : mData( nullptr ),mSize( 0 ),mFile( -1 ) {}
+#endif
+	~MappedFile() { Close(); }
+	MappedFile( const MappedFile& ) = delete;
+	MappedFile& operator=( const MappedFile& ) = delete;
+
+	bool Open( const char *path )
+	{
+		Close();
+#ifdef _WIN32
+		mFile = CreateFileA( path,GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr );
+		if ( mFile == INVALID_HANDLE_VALUE )
+		{
+			return false;
+		}
+		LARGE_INTEGER size;
+		if ( !GetFileSizeEx( mFile,&size ) || size.QuadPart == 0 )
+		{
+			Close();
+			return false;
+		}
+		mMapping = CreateFileMappingA( mFile,nullptr,PAGE_READONLY,0,0,nullptr );
+		if ( mMapping == nullptr )
+		{
+			Close();
+			return false;
+		}
+		mData = MapViewOfFile( mMapping,FILE_MAP_READ,0,0,0 );
+		mSize = (size_t)size.QuadPart;
+#else
+		mFile = open( path,O_RDONLY );
+		if ( mFile < 0 )
+		{
+			return false;
+		}
+		struct stat info;
+		if ( fstat( mFile,&info ) != 0 || info.st_size == 0 )
+		{
+			Close();
+			return false;
+		}
+		void *data = mmap( nullptr,(size_t)info.st_size,PROT_READ,MAP_SHARED,mFile,0 );
+		mData = data == MAP_FAILED ? nullptr : data;
+		mSize = (size_t)info.st_size;
+#endif
+		if ( mData == nullptr )
+		{
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void Close()
+	{
+#ifdef _WIN32
+		if ( mData )
+		{
+			UnmapViewOfFile( mData );
+		}
+		if ( mMapping )
+		{
+			CloseHandle( mMapping );
+		}
+		if ( mFile != INVALID_HANDLE_VALUE )
+		{
+			CloseHandle( mFile );
+		}
+		mMapping = nullptr;
+		mFile = INVALID_HANDLE_VALUE;
+#else
+		if ( mData )
+		{
+			munmap( (void*)mData,mSize );
+		}
+		if ( mFile >= 0 )
+		{
+			close( mFile );
+		}
+		mFile = -1;
+#endif
+		mData = nullptr;
+		mSize = 0;
+	}
+
+	bool IsOpen() const { return mData != nullptr; }
+	const void* Data() const { return mData; }
+	size_t Size() const { return mSize; }
+};
@@ -0,0 +1,198 @@
+#pragma once
+#include "TMat.h"
+#include <type_traits>
+
+// Compile-time matrix kinds. Wrapping a 4 x 4 matrix in Rotation<>, Rigid<>
+// or Affine<> records that its bottom row is (0,0,0,1) (and, for the first
+// two, that the upper 3 x 3 is orthonormal), so products, inverses and point
+// transforms can use reduced kernels. Products of two kinds yield the wider
+// of the two; mixing with a plain matrix falls back to the full 4 x 4 math.
+// Wrapping is a promise about the contents, it is not checked.
+
+struct MatKindRotation { static const int rank = 0; };
+struct MatKindRigid { static const int rank = 1; };
+struct MatKindAffine { static const int rank = 2; };
+
+template<typename A,typename B>
+struct TMatKindJoin
+{
+	typedef typename std::conditional<(A::rank >= B::rank),A,B>::type type;
+};
+
+template<typename K,typename M>
+struct TKindMat
+{
+	typedef K kind;
+	typedef M matrix_type;
+	typedef typename M::value_type value_type;
+	M m;
+	constexpr TKindMat() : m( identityOf() ) {};
+	constexpr explicit TKindMat( const M &_m ) : m( _m ) {};
+	template<typename K2,typename = typename std::enable_if<(K2::rank <= K::rank)>::type>
+	constexpr TKindMat( const TKindMat<K2,M> &narrower ) : m( narrower.m ) {};
+	constexpr operator const M&() const { return m; }
+	constexpr const M& matrix() const { return m; }
+private:
+	static constexpr M identityOf()
+	{
+		return M( 1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1 );
+	}
+};
+
+template<typename M> using Rotation = TKindMat<MatKindRotation,M>;
+template<typename M> using Rigid = TKindMat<MatKindRigid,M>;
+template<typename M> using Affine = TKindMat<MatKindAffine,M>;
+
+template<typename M>
+constexpr Rotation<M> asRotation( const M &m ) { return Rotation<M>( m ); }
+template<typename M>
+constexpr Rigid<M> asRigid( const M &m ) { return Rigid<M>( m ); }
+template<typename M>
+constexpr Affine<M> asAffine( const M &m ) { return Affine<M>( m ); }
+
+// Reduced kernels, column major with the translation in v[12..14].
+template<typename K>
+struct TMatKindOps
+{
+	// 3 x 4 product, bottom row known to be (0,0,0,1) on both sides.
+	template<typename T>
+	static constexpr TMat<T,4,4> mul( const TMat<T,4,4> &a,const TMat<T,4,4> &b )
+	{
+		TMat<T,4,4> r;
+		for ( int c = 0; c < 4; ++c )
+		{
+			for ( int row = 0; row < 3; ++row )
+			{
+				r.v[c * 4 + row] = a.v[row] * b.v[c * 4] + a.v[4 + row] * b.v[c * 4 + 1] + a.v[8 + row] * b.v[c * 4 + 2];
+			}
+		}
+		r.v[12] += a.v[12];
+		r.v[13] += a.v[13];
+		r.v[14] += a.v[14];
+		r.v[15] = T( 1 );
+		return r;
+	}
+	// General 3 x 3 inverse through cofactors, then -inv * t.
+	template<typename T>
+	static constexpr TMat<T,4,4> inverse( const TMat<T,4,4> &m )
+	{
+		const T *a = m.v;
+		T c00 = a[5] * a[10] - a[9] * a[6];
+		T c01 = a[9] * a[2] - a[1] * a[10];
+		T c02 = a[1] * a[6] - a[5] * a[2];
+		T det = a[0] * c00 + a[4] * c01 + a[8] * c02;
+		if ( det == T( 0 ) )
+		{
+			return TMat<T,4,4>();
+		}
+		T id = T( 1 ) / det;
+		TMat<T,4,4> r;
+		r.v[0] = c00 * id;
+		r.v[1] = c01 * id;
+		r.v[2] = c02 * id;
+		r.v[4] = (a[8] * a[6] - a[4] * a[10]) * id;
+		r.v[5] = (a[0] * a[10] - a[8] * a[2]) * id;
+		r.v[6] = (a[4] * a[2] - a[0] * a[6]) * id;
+		r.v[8] = (a[4] * a[9] - a[8] * a[5]) * id;
+		r.v[9] = (a[8] * a[1] - a[0] * a[9]) * id;
+		r.v[10] = (a[0] * a[5] - a[4] * a[1]) * id;
+		for ( int row = 0; row < 3; ++row )
+		{
+			r.v[12 + row] = -(r.v[row] * a[12] + r.v[4 + row] * a[13] + r.v[8 + row] * a[14]);
+		}
+		r.v[15] = T( 1 );
+		return r;
+	}
+};
+
+template<>
+struct TMatKindOps<MatKindRigid> : public TMatKindOps<MatKindAffine>
+{
+	// Orthonormal 3 x 3: the inverse is the transpose, translation is -R^T t.
+	template<typename T>
+	static constexpr TMat<T,4,4> inverse( const TMat<T,4,4> &m )
+	{
+		const T *a = m.v;
+		return TMat<T,4,4>(
+			a[0],a[4],a[8],0,
+			a[1],a[5],a[9],0,
+			a[2],a[6],a[10],0,
+			-(a[0] * a[12] + a[1] * a[13] + a[2] * a[14]),
+			-(a[4] * a[12] + a[5] * a[13] + a[6] * a[14]),
+			-(a[8] * a[12] + a[9] * a[13] + a[10] * a[14]),1 );
+	}
+};
+
+template<>
+struct TMatKindOps<MatKindRotation>
+{
+	template<typename T>
+	static constexpr TMat<T,4,4> mul( const TMat<T,4,4> &a,const TMat<T,4,4> &b )
+	{
+		TMat<T,4,4> r;
+		for ( int c = 0; c < 3; ++c )
+		{
+			for ( int row = 0; row < 3; ++row )
+			{
+				r.v[c * 4 + row] = a.v[row] * b.v[c * 4] + a.v[4 + row] * b.v[c * 4 + 1] + a.v[8 + row] * b.v[c * 4 + 2];
+			}
+		}
+		r.v[15] = T( 1 );
+		return r;
+	}
+	template<typename T>
+	static constexpr TMat<T,4,4> inverse( const TMat<T,4,4> &m )
+	{
+		const T *a = m.v;
+		return TMat<T,4,4>(
+			a[0],a[4],a[8],0,
+			a[1],a[5],a[9],0,
+			a[2],a[6],a[10],0,
+			0,0,0,1 );
+	}
+};
+
+template<typename K1,typename K2,typename M>
+constexpr TKindMat<typename TMatKindJoin<K1,K2>::type,M> operator*( const TKindMat<K1,M> &a,const TKindMat<K2,M> &b )
+{
+	typedef typename TMatKindJoin<K1,K2>::type K;
+	return TKindMat<K,M>( TMatKindOps<K>::mul( a.m,b.m ) );
+}
+
+template<typename K,typename M>
+constexpr M operator*( const TKindMat<K,M> &a,const M &b )
+{
+	return a.m * b;
+}
+
+template<typename K,typename M>
+constexpr M operator*( const M &a,const TKindMat<K,M> &b )
+{
+	return a * b.m;
+}
+
+template<typename K,typename M>
+constexpr TKindMat<K,M> inverse( const TKindMat<K,M> &a )
+{
+	return TKindMat<K,M>( TMatKindOps<K>::inverse( a.m ) );
+}
+
+template<typename K,typename T>
+constexpr TVec<T,3> transformPoint( const TKindMat<K,TMat<T,4,4> > &a,const TVec<T,3> &p )
+{
+	const T *m = a.m.v;
+	return TVec<T,3>(
+		m[0] * p.v[0] + m[4] * p.v[1] + m[8] * p.v[2] + m[12],
+		m[1] * p.v[0] + m[5] * p.v[1] + m[9] * p.v[2] + m[13],
+		m[2] * p.v[0] + m[6] * p.v[1] + m[10] * p.v[2] + m[14] );
+}
+
+template<typename K,typename T>
+constexpr TVec<T,3> transformVector( const TKindMat<K,TMat<T,4,4> > &a,const TVec<T,3> &p )
+{
+	const T *m = a.m.v;
+	return TVec<T,3>(
+		m[0] * p.v[0] + m[4] * p.v[1] + m[8] * p.v[2],
+		m[1] * p.v[0] + m[5] * p.v[1] + m[9] * p.v[2],
+		m[2] * p.v[0] + m[6] * p.v[1] + m[10] * p.v[2] );
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Skinning.h"
+
+// Range boundaries are multiples of this many vertices: four float4 outputs
+// fill one 64 byte cache line, so with line aligned output buffers no two
+// threads ever write the same line. It is also the dual quaternion kernel's
+// block size, so every vertex takes the same code path whatever the thread
+// count and the output is bit-identical from 1 to N threads.
+#define SKIN_PARALLEL_GRAIN 4
+
+// Persistent worker threads for the skinning driver. Run hands every thread
+// (the caller included) its own index and returns once all have finished;
+// nothing is allocated per call.
+class SkinningWorkers
+{
+	std::vector<std::thread> mThreads;
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	std::condition_variable mDone;
+	void (*mInvoke)( void*,unsigned int );
+	void *mContext;
+	unsigned int mGeneration;
+	unsigned int mPending;
+	bool mQuit;
+
+	void WorkerLoop( unsigned int index )
+	{
+		unsigned int seen = 0;
+		for ( ;; )
+		{
+			void (*invoke)( void*,unsigned int );
+			void *context;
+			{
+				std::unique_lock<std::mutex> lock( mMutex );
+				mWake.wait( lock,[&]() { return mQuit || mGeneration != seen; } );
+				if ( mQuit )
+				{
+					return;
+				}
+				seen = mGeneration;
+				invoke = mInvoke;
+				context = mContext;
+			}
+			invoke( context,index );
+			std::lock_guard<std::mutex> lock( mMutex );
+			if ( --mPending == 0 )
+			{
+				mDone.notify_one();
+			}
+		}
+	}
+
+	template<typename F>
+	static void Invoke( void *context,unsigned int index ) { (*(F*)context)( index ); }
+public:
+	// threads counts the calling thread, so 1 spawns nothing.
+	explicit SkinningWorkers( unsigned int threads )
+		:
+		mInvoke( nullptr ),
+		mContext( nullptr ),
+		mGeneration( 0 ),
+		mPending( 0 ),
+		mQuit( false )
+	{
+		for ( unsigned int i = 1; i < threads; ++i )
+		{
+			mThreads.emplace_back( &SkinningWorkers::WorkerLoop,this,i );
+		}
+	}
+	~SkinningWorkers()
+	{
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			mQuit = true;
+		}
+		mWake.notify_all();
+		for ( size_t i = 0; i < mThreads.size(); ++i )
+		{
+			mThreads[i].join();
+		}
+	}
+	SkinningWorkers( const SkinningWorkers& ) = delete;
+	SkinningWorkers& operator=( const SkinningWorkers& ) = delete;
+
+	unsigned int GetThreadCount() const { return (unsigned int)mThreads.size() + 1; }
+
+	// Calls job( index ) once per thread, index in [0, GetThreadCount()).
+	template<typename F>
+	void Run( F &job )
+	{
+		if ( !mThreads.empty() )
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			mInvoke = &Invoke<F>;
+			mContext = &job;
+			mPending = (unsigned int)mThreads.size();
+			++mGeneration;
+		}
+		mWake.notify_all();
+		job( 0u );
+		std::unique_lock<std::mutex> lock( mMutex );
+		mDone.wait( lock,[&]() { return mPending == 0; } );
+	}
+};
+
+// Start of thread index's range; the ranges split count evenly in whole grains.
+inline size_t skinRangeBegin( size_t count,unsigned int index,unsigned int threads )
+{
+	size_t grains = (count + SKIN_PARALLEL_GRAIN - 1) / SKIN_PARALLEL_GRAIN;
+	size_t begin = grains * index / threads * SKIN_PARALLEL_GRAIN;
+	return begin < count ? begin : count;
+}
+
+// The palette and inputs are only read, so all threads share them as is.
+template<typename W,int N>
+void skinLinearParallel( SkinningWorkers &workers,const vec3 *positions,const vec3 *normals,
+	const TPackedInfluence<W,N> *influences,const mat3x4 *palette,size_t count,
+	vec4 *outPositions,vec4 *outNormals,bool streaming = false )
+{
+	unsigned int threads = workers.GetThreadCount();
+	auto job = [&]( unsigned int index )
+	{
+		size_t begin = skinRangeBegin( count,index,threads );
+		size_t end = skinRangeBegin( count,index + 1,threads );
+		skinLinear( positions + begin,normals ? normals + begin : nullptr,influences + begin,palette,end - begin,
+			outPositions + begin,outNormals ? outNormals + begin : nullptr,streaming );
+	};
+	workers.Run( job );
+}
+
+template<typename W,int N>
+void skinDualQuaternionParallel( SkinningWorkers &workers,const vec3 *positions,const vec3 *normals,
+	const TPackedInfluence<W,N> *influences,const DualQuaternion *palette,size_t count,
+	vec4 *outPositions,vec4 *outNormals,bool streaming = false )
+{
+	unsigned int threads = workers.GetThreadCount();
+	auto job = [&]( unsigned int index )
+	{
+		size_t begin = skinRangeBegin( count,index,threads );
+		size_t end = skinRangeBegin( count,index + 1,threads );
+		skinDualQuaternion( positions + begin,normals ? normals + begin : nullptr,influences + begin,palette,end - begin,
+			outPositions + begin,outNormals ? outNormals + begin : nullptr,streaming );
+	};
+	workers.Run( job );
+}
@@ -0,0 +1,213 @@
+#pragma once
+#include <vector>
+#include "Track.h"
+
+// Sampling on raw arrays, shared by PolynomialTrack and by keys that live
+// in memory nothing owns, such as a mapped AnimationAsset file. times has
+// count keys; coefficients holds 4 * N floats per key (see below).
+
+// Same time mapping as Track::AdjustTimeToFitTrack.
+inline float polynomialAdjustTime( const float *times,unsigned int count,float time,bool looping )
+{
+	if ( count <= 1 )
+	{
+		return count == 0 ? 0.0f : times[0];
+	}
+	float start = times[0];
+	float end = times[count - 1];
+	float duration = end - start;
+	if ( duration <= 0.0f )
+	{
+		return start;
+	}
+	if ( looping )
+	{
+		time = fmodf( time - start,duration );
+		if ( time < 0.0f )
+		{
+			time += duration;
+		}
+		return time + start;
+	}
+	return time < start ? start : (time > end ? end : time);
+}
+
+// Segment for an adjusted time: the last key's at or past the end.
+inline int polynomialSegmentIndex( const float *times,unsigned int count,float time )
+{
+	int size = (int)count;
+	if ( size <= 1 || time >= times[size - 1] )
+	{
+		return size - 1;
+	}
+	int lo = 0;
+	int n = size - 1;
+	while ( n > 1 )
+	{
+		int half = n / 2;
+		if ( times[lo + half] <= time )
+		{
+			lo += half;
+			n -= half;
+		}
+		else
+		{
+			n = half;
+		}
+	}
+	return lo;
+}
+
+template<int N>
+void polynomialEvaluate( const float *coefficients,const float *times,int segment,float time,float *out )
+{
+	const float *c = coefficients + (size_t)segment * 4 * N;
+	float dt = time - times[segment];
+	for ( int k = 0; k < N; ++k )
+	{
+		out[k] = ((c[3 * N + k] * dt + c[2 * N + k]) * dt + c[N + k]) * dt + c[k];
+	}
+}
+
+// Track preprocessed at load time into one cubic polynomial per segment,
+// in seconds from the segment's start:
+//   value( t ) = ((c3 * dt + c2) * dt + c1) * dt + c0, dt = t - key time
+// Cubic segments get their Hermite basis folded in, linear ones have c2 and
+// c3 zero and constant ones only c0, so every mode evaluates the same
+// branch free way, in three fused multiply-adds per component. Quaternion
+// keys are flipped onto the previous key's hemisphere once, tangents with
+// them, so no dot product sign test is left at runtime; the result is
+// only normalized. One extra segment holds the last key for times at or
+// past the end, which is where Track returns the last key too.
+template<typename T,int N>
+class PolynomialTrack
+{
+protected:
+	std::vector<float> mTimes;
+	std::vector<float> mCoefficients; // per segment: c0[N], c1[N], c2[N], c3[N]
+public:
+	typedef T value_type;
+	static const int components = N;
+
+	PolynomialTrack() {}
+	explicit PolynomialTrack( const Track<T,N> &track ) { Build( track ); }
+
+	void Build( const Track<T,N> &track )
+	{
+		unsigned int size = track.Size();
+		mTimes.resize( size );
+		mCoefficients.assign( (size_t)size * 4 * N,0.0f );
+		if ( size == 0 )
+		{
+			return;
+		}
+		// Keys as sampled: quaternions normalized like TTrackValue::cast,
+		// then made to share a hemisphere with their predecessor.
+		std::vector<float> values( (size_t)size * N );
+		std::vector<float> in( (size_t)size * N );
+		std::vector<float> out( (size_t)size * N );
+		for ( unsigned int i = 0; i < size; ++i )
+		{
+			T value = TTrackValue<T>::cast( track[i].mValue );
+			const float *v = (const float*)&value;
+			float sign = 1.0f;
+			if ( N == 4 && i > 0 )
+			{
+				float d = 0.0f;
+				for ( int c = 0; c < N; ++c )
+				{
+					d += v[c] * values[(i - 1) * N + c];
+				}
+				sign = d < 0.0f ? -1.0f : 1.0f;
+			}
+			for ( int c = 0; c < N; ++c )
+			{
+				values[i * N + c] = v[c] * sign;
+				in[i * N + c] = track[i].mIn[c] * sign;
+				out[i * N + c] = track[i].mOut[c] * sign;
+			}
+			mTimes[i] = track[i].mTime;
+		}
+		Interpolation interp = track.GetInterpolation();
+		for ( unsigned int i = 0; i < size; ++i )
+		{
+			float *c = mCoefficients.data() + (size_t)i * 4 * N;
+			const float *p1 = values.data() + i * N;
+			if ( i + 1 == size )
+			{
+				for ( int k = 0; k < N; ++k )
+				{
+					c[k] = p1[k];
+				}
+				continue;
+			}
+			const float *p2 = values.data() + (i + 1) * N;
+			float h = mTimes[i + 1] - mTimes[i];
+			for ( int k = 0; k < N; ++k )
+			{
+				if ( h <= 0.0f )
+				{
+					c[k] = p2[k];
+				}
+				else if ( interp == Interpolation::Constant )
+				{
+					c[k] = p1[k];
+				}
+				else if ( interp == Interpolation::Linear )
+				{
+					c[k] = p1[k];
+					c[N + k] = (p2[k] - p1[k]) / h;
+				}
+				else
+				{
+					// Hermite in u = dt / h, tangents scaled to the segment,
+					// then rescaled to dt.
+					float m1 = out[i * N + k] * h;
+					float m2 = in[(i + 1) * N + k] * h;
+					float a = 2.0f * p1[k] - 2.0f * p2[k] + m1 + m2;
+					float b = -3.0f * p1[k] + 3.0f * p2[k] - 2.0f * m1 - m2;
+					c[k] = p1[k];
+					c[N + k] = out[i * N + k];
+					c[2 * N + k] = b / (h * h);
+					c[3 * N + k] = a / (h * h * h);
+				}
+			}
+		}
+	}
+
+	unsigned int Size() const { return (unsigned int)mTimes.size(); }
+	float GetStartTime() const { return mTimes.empty() ? 0.0f : mTimes.front(); }
+	float GetEndTime() const { return mTimes.empty() ? 0.0f : mTimes.back(); }
+	size_t GetCoefficientBytes() const { return mCoefficients.size() * sizeof( float ); }
+
+	const float* GetTimes() const { return mTimes.data(); }
+	const float* GetCoefficients() const { return mCoefficients.data(); }
+
+	float AdjustTimeToFitTrack( float time,bool looping ) const
+	{
+		return polynomialAdjustTime( mTimes.data(),Size(),time,looping );
+	}
+
+	int SegmentIndex( float time ) const { return polynomialSegmentIndex( mTimes.data(),Size(),time ); }
+
+	T SampleSegment( int segment,float time ) const
+	{
+		float result[N];
+		polynomialEvaluate<N>( mCoefficients.data(),mTimes.data(),segment,time,result );
+		return TTrackValue<T>::cast( result );
+	}
+
+	T Sample( float time,bool looping ) const
+	{
+		if ( mTimes.empty() )
+		{
+			return T();
+		}
+		float t = AdjustTimeToFitTrack( time,looping );
+		return SampleSegment( SegmentIndex( t ),t );
+	}
+};
+
+typedef PolynomialTrack<float,1> PolynomialScalarTrack;
+typedef PolynomialTrack<vec3,3> PolynomialVectorTrack;
+typedef PolynomialTrack<quat,4> PolynomialQuaternionTrack;
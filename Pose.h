@@ -0,0 +1,161 @@
+#pragma once
+#include <vector>
+#include <stdint.h>
+#include "Transform.h"
+
+// Local joint transforms in a flat array, ordered so every parent comes
+// before its children (parent index < joint index, -1 for roots). That
+// ordering lets all global transforms be built front to back in one linear
+// pass, each joint reading its parent's already finished result.
+class Pose
+{
+protected:
+	std::vector<Transform> mJoints;
+	std::vector<int16_t> mParents;
+public:
+	Pose() {}
+	explicit Pose( unsigned int numJoints ) { Resize( numJoints ); }
+
+	void Resize( unsigned int size )
+	{
+		mJoints.resize( size );
+		mParents.resize( size,-1 );
+	}
+	unsigned int Size() const { return (unsigned int)mJoints.size(); }
+
+	int GetParent( unsigned int index ) const { return mParents[index]; }
+	// parent must be -1 or lower than index.
+	void SetParent( unsigned int index,int parent ) { mParents[index] = (int16_t)parent; }
+	const int16_t* GetParents() const { return mParents.data(); }
+
+	const Transform& GetLocalTransform( unsigned int index ) const { return mJoints[index]; }
+	void SetLocalTransform( unsigned int index,const Transform &transform ) { mJoints[index] = transform; }
+	const Transform* GetLocalTransforms() const { return mJoints.data(); }
+	Transform* GetLocalTransforms() { return mJoints.data(); }
+
+	bool IsTopologicallySorted() const
+	{
+		for ( unsigned int i = 0, size = Size(); i < size; ++i )
+		{
+			if ( mParents[i] >= (int)i )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Single joint query: walks up the parent chain, O(depth).
+	Transform GetGlobalTransform( unsigned int index ) const
+	{
+		Transform result = mJoints[index];
+		for ( int p = mParents[index]; p >= 0; p = mParents[p] )
+		{
+			result = combine( mJoints[p],result );
+		}
+		return result;
+	}
+
+	// Every joint in one O(n) pass; out must hold Size() transforms.
+	void GetGlobalTransforms( Transform *out ) const
+	{
+		for ( unsigned int i = 0, size = Size(); i < size; ++i )
+		{
+			int p = mParents[i];
+			out[i] = p < 0 ? mJoints[i] : combine( out[p],mJoints[i] );
+		}
+	}
+
+	void GetGlobalTransforms( std::vector<Transform> &out ) const
+	{
+		out.resize( Size() );
+		GetGlobalTransforms( out.data() );
+	}
+
+	// Reorders joints so that new joint i is old joint order[i], remapping
+	// the parent indices to match.
+	void Remap( const std::vector<int> &order )
+	{
+		std::vector<int> newIndex( order.size() );
+		for ( unsigned int i = 0; i < order.size(); ++i )
+		{
+			newIndex[order[i]] = (int)i;
+		}
+		std::vector<Transform> joints( order.size() );
+		std::vector<int16_t> parents( order.size() );
+		for ( unsigned int i = 0; i < order.size(); ++i )
+		{
+			joints[i] = mJoints[order[i]];
+			int p = mParents[order[i]];
+			parents[i] = (int16_t)(p < 0 ? -1 : newIndex[p]);
+		}
+		mJoints.swap( joints );
+		mParents.swap( parents );
+	}
+
+	bool operator==( const Pose &other ) const
+	{
+		if ( Size() != other.Size() )
+		{
+			return false;
+		}
+		for ( unsigned int i = 0, size = Size(); i < size; ++i )
+		{
+			if ( mParents[i] != other.mParents[i] || mJoints[i] != other.mJoints[i] )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	bool operator!=( const Pose &other ) const { return !(*this == other); }
+};
+
+// Per joint mix of two poses of the same layout; out may alias a or b and
+// must already have the right size, so nothing is allocated.
+inline void blend( const Pose &a,const Pose &b,float t,Pose &out )
+{
+	const Transform *ja = a.GetLocalTransforms();
+	const Transform *jb = b.GetLocalTransforms();
+	Transform *jo = out.GetLocalTransforms();
+	for ( unsigned int i = 0, size = out.Size(); i < size; ++i )
+	{
+		jo[i] = mix( ja[i],jb[i],t );
+	}
+}
+
+// Breadth-first order of a parent array given in any order, for Pose::Remap.
+// Returns false if the parents do not form a forest.
+inline bool topologicalOrder( const std::vector<int> &parents,std::vector<int> &order )
+{
+	int size = (int)parents.size();
+	std::vector<int> firstChild( size,-1 );
+	std::vector<int> nextSibling( size,-1 );
+	order.clear();
+	order.reserve( size );
+	for ( int i = size - 1; i >= 0; --i )
+	{
+		int p = parents[i];
+		if ( p < 0 || p >= size )
+		{
+			continue;
+		}
+		nextSibling[i] = firstChild[p];
+		firstChild[p] = i;
+	}
+	for ( int i = 0; i < size; ++i )
+	{
+		if ( parents[i] < 0 )
+		{
+			order.push_back( i );
+		}
+	}
+	for ( size_t head = 0; head < order.size(); ++head )
+	{
+		for ( int c = firstChild[order[head]]; c >= 0; c = nextSibling[c] )
+		{
+			order.push_back( c );
+		}
+	}
+	return (int)order.size() == size;
+}
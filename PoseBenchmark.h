@@ -0,0 +1,125 @@
+#pragma once
+#include <vector>
+#include <stdlib.h>
+#include "Benchmark.h"
+#include "Pose.h"
+#include "PoseSoA.h"
+
+// Pose layering throughput in joints per second: per-joint AoS blending with
+// mix( Transform ) against the SoA streams in PoseSoA.h.
+
+inline void fillBenchmarkPose( Pose &pose,unsigned int joints )
+{
+	pose.Resize( joints );
+	for ( unsigned int i = 0; i < joints; ++i )
+	{
+		float r[7];
+		for ( int k = 0; k < 7; ++k )
+		{
+			r[k] = float( rand() ) / float( RAND_MAX ) * 2.0f - 1.0f;
+		}
+		pose.SetParent( i,(int)i - 1 );
+		pose.SetLocalTransform( i,Transform( vec3( r[0],r[1],r[2] ),normalized( quat( r[3],r[4],r[5],r[6] ) ),vec3( 1,1,1 ) ) );
+	}
+}
+
+// AoS additive layer matching add( PoseSoA ): delta rotation taken along the
+// short arc from identity, applied after the base rotation.
+inline Transform addAoS( const Transform &base,const Transform &delta,float w )
+{
+	quat d = delta.rotation.w < 0.0f ? -delta.rotation : delta.rotation;
+	quat q = nlerp( quat( 0,0,0,1 ),d,w );
+	return Transform( base.position + delta.position * w,base.rotation * q,base.scale + delta.scale * w );
+}
+
+inline void benchmarkPoseBlending( unsigned int joints = 80,unsigned int repeat = 50000,unsigned int layers = 5 )
+{
+	srand( 99 );
+	Pose a,b,delta,out;
+	fillBenchmarkPose( a,joints );
+	fillBenchmarkPose( b,joints );
+	fillBenchmarkPose( delta,joints );
+	out = a;
+	PoseSoA sa( a ),sb( b ),sd( delta ),so( a );
+	std::vector<float> mask( joints );
+	for ( unsigned int i = 0; i < joints; ++i )
+	{
+		mask[i] = i < joints / 2 ? 1.0f : 0.25f;
+	}
+	double items = double( joints ) * repeat;
+
+	BenchmarkResult r = runBenchmark( "blend aos",items,[&]()
+	{
+		for ( unsigned int n = 0; n < repeat; ++n )
+		{
+			float t = float( n & 255 ) / 255.0f;
+			for ( unsigned int i = 0; i < joints; ++i )
+			{
+				out.SetLocalTransform( i,mix( a.GetLocalTransform( i ),b.GetLocalTransform( i ),t ) );
+			}
+		}
+		benchmarkSink() = out.GetLocalTransform( joints / 2 ).rotation.x;
+	} );
+	printBenchmark( r,"joints" );
+
+	r = runBenchmark( "blend soa",items,[&]()
+	{
+		for ( unsigned int n = 0; n < repeat; ++n )
+		{
+			blend( sa,sb,float( n & 255 ) / 255.0f,so );
+		}
+		benchmarkSink() = so.GetStreams().rx[joints / 2];
+	} );
+	printBenchmark( r,"joints" );
+
+	r = runBenchmark( "masked blend soa",items,[&]()
+	{
+		for ( unsigned int n = 0; n < repeat; ++n )
+		{
+			blend( sa,sb,mask.data(),float( n & 255 ) / 255.0f,so );
+		}
+		benchmarkSink() = so.GetStreams().rx[joints / 2];
+	} );
+	printBenchmark( r,"joints" );
+
+	r = runBenchmark( "add aos",items,[&]()
+	{
+		for ( unsigned int n = 0; n < repeat; ++n )
+		{
+			float w = float( n & 255 ) / 255.0f;
+			for ( unsigned int i = 0; i < joints; ++i )
+			{
+				out.SetLocalTransform( i,addAoS( a.GetLocalTransform( i ),delta.GetLocalTransform( i ),w ) );
+			}
+		}
+		benchmarkSink() = out.GetLocalTransform( joints / 2 ).rotation.x;
+	} );
+	printBenchmark( r,"joints" );
+
+	r = runBenchmark( "add soa",items,[&]()
+	{
+		for ( unsigned int n = 0; n < repeat; ++n )
+		{
+			add( sa,sd,float( n & 255 ) / 255.0f,so );
+		}
+		benchmarkSink() = so.GetStreams().rx[joints / 2];
+	} );
+	printBenchmark( r,"joints" );
+
+	// A full character: one crossfade plus layers - 1 masked additive layers,
+	// all in place on the output pose.
+	r = runBenchmark( "layer stack soa",items,[&]()
+	{
+		for ( unsigned int n = 0; n < repeat; ++n )
+		{
+			float t = float( n & 255 ) / 255.0f;
+			blend( sa,sb,t,so );
+			for ( unsigned int l = 1; l < layers; ++l )
+			{
+				add( so,sd,mask.data(),t * 0.25f,so );
+			}
+		}
+		benchmarkSink() = so.GetStreams().rx[joints / 2];
+	} );
+	printBenchmark( r,"joints" );
+}
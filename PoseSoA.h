@@ -0,0 +1,293 @@
+#pragma once
+#include <vector>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include <assert.h>
+#include "Pose.h"
+
+// Streams are padded to a multiple of this many joints: one AVX2 register
+// of floats. Padding lanes hold the identity transform, so every loop below
+// runs over whole registers without a scalar tail.
+#define POSE_SOA_WIDTH 8
+
+// Pose with one float stream per component (TransformSoA) for layering.
+// The blend and additive operations are plain loops with no branches or
+// calls besides sqrtf, written so the compiler vectorizes them across joints
+// (MSVC /arch:AVX2; GCC and Clang also need -fno-math-errno for sqrtf).
+class PoseSoA
+{
+protected:
+	TransformSoA mJoints;
+	std::vector<int16_t> mParents;
+	unsigned int mSize;
+public:
+	PoseSoA() : mSize( 0 ) {}
+	explicit PoseSoA( const Pose &pose ) : mSize( 0 ) { Load( pose ); }
+
+	void Resize( unsigned int size )
+	{
+		mSize = size;
+		mJoints.Resize( (size + POSE_SOA_WIDTH - 1) & ~(POSE_SOA_WIDTH - 1) );
+		mParents.resize( size,-1 );
+	}
+	unsigned int Size() const { return mSize; }
+	unsigned int PaddedSize() const { return mJoints.Size(); }
+	// Size and parents of other; the streams are left to be overwritten.
+	// Does not allocate once this pose has held as many joints before.
+	void MatchLayout( const PoseSoA &other )
+	{
+		if ( this != &other )
+		{
+			Resize( other.mSize );
+			mParents.assign( other.mParents.begin(),other.mParents.end() );
+		}
+	}
+
+	int GetParent( unsigned int index ) const { return mParents[index]; }
+	void SetParent( unsigned int index,int parent ) { mParents[index] = (int16_t)parent; }
+	Transform GetLocalTransform( unsigned int index ) const { return mJoints.Get( index ); }
+	void SetLocalTransform( unsigned int index,const Transform &t ) { mJoints.Set( index,t ); }
+	const TransformSoA& GetStreams() const { return mJoints; }
+	TransformSoA& GetStreams() { return mJoints; }
+
+	void Load( const Pose &pose )
+	{
+		Resize( pose.Size() );
+		for ( unsigned int i = 0; i < mSize; ++i )
+		{
+			mJoints.Set( i,pose.GetLocalTransform( i ) );
+			mParents[i] = (int16_t)pose.GetParent( i );
+		}
+	}
+	void Store( Pose &pose ) const
+	{
+		pose.Resize( mSize );
+		for ( unsigned int i = 0; i < mSize; ++i )
+		{
+			pose.SetLocalTransform( i,mJoints.Get( i ) );
+			pose.SetParent( i,mParents[i] );
+		}
+	}
+};
+
+// Per-stream kernels over joints [begin, end), both multiples of
+// POSE_SOA_WIDTH; out may alias the inputs, element for element. The weight
+// accessor is a template parameter rather than a null check inside the loop,
+// which would stop vectorization.
+
+struct SoaWeight
+{
+	float t;
+	float operator()( unsigned int ) const { return t; }
+};
+
+struct SoaMaskedWeight
+{
+	const float *weights;
+	float t;
+	float operator()( unsigned int i ) const { return weights[i] * t; }
+};
+
+// Weights of the last, partial block, copied into a full register block
+// whose lanes past the pose's size are zero.
+struct SoaTailWeight
+{
+	float weights[POSE_SOA_WIDTH];
+	unsigned int begin;
+	float t;
+	SoaTailWeight( const float *source,unsigned int _begin,unsigned int count,float _t ) : weights(),begin( _begin ),t( _t )
+	{
+		memcpy( weights,source + begin,count * sizeof( float ) );
+	}
+	float operator()( unsigned int i ) const { return weights[i - begin] * t; }
+};
+
+// The many-stream kernels compute a block of POSE_SOA_WIDTH joints into
+// locals and store it afterwards. Locals cannot alias the inputs, so the
+// compiler needs no runtime overlap checks (of which there would be too
+// many to vectorize) and out may still be one of the inputs.
+
+template<typename Weight>
+inline void soaLerp( const float *a,const float *b,Weight weight,float *out,unsigned int begin,unsigned int end )
+{
+	for ( unsigned int i = begin; i < end; ++i )
+	{
+		out[i] = a[i] + (b[i] - a[i]) * weight( i );
+	}
+}
+
+// Neighborhooded nlerp, as mix( Transform ) does per joint.
+template<typename Weight>
+inline void soaNlerp( const TransformSoA &a,const TransformSoA &b,Weight weight,TransformSoA &out,unsigned int begin,unsigned int end )
+{
+	const float *ax = a.rx.data(),*ay = a.ry.data(),*az = a.rz.data(),*aw = a.rw.data();
+	const float *bx = b.rx.data(),*by = b.ry.data(),*bz = b.rz.data(),*bw = b.rw.data();
+	float *ox = out.rx.data(),*oy = out.ry.data(),*oz = out.rz.data(),*ow = out.rw.data();
+	for ( unsigned int i = begin; i < end; i += POSE_SOA_WIDTH )
+	{
+		float qx[POSE_SOA_WIDTH],qy[POSE_SOA_WIDTH],qz[POSE_SOA_WIDTH],qw[POSE_SOA_WIDTH];
+		for ( unsigned int k = 0; k < POSE_SOA_WIDTH; ++k )
+		{
+			unsigned int j = i + k;
+			float wt = weight( j );
+			float d = ax[j] * bx[j] + ay[j] * by[j] + az[j] * bz[j] + aw[j] * bw[j];
+			float bt = d < 0.0f ? -wt : wt;
+			float s = 1.0f - wt;
+			float x = ax[j] * s + bx[j] * bt;
+			float y = ay[j] * s + by[j] * bt;
+			float z = az[j] * s + bz[j] * bt;
+			float w = aw[j] * s + bw[j] * bt;
+			float inv = 1.0f / sqrtf( x * x + y * y + z * z + w * w );
+			qx[k] = x * inv; qy[k] = y * inv; qz[k] = z * inv; qw[k] = w * inv;
+		}
+		memcpy( ox + i,qx,sizeof( qx ) ); memcpy( oy + i,qy,sizeof( qy ) );
+		memcpy( oz + i,qz,sizeof( qz ) ); memcpy( ow + i,qw,sizeof( qw ) );
+	}
+}
+
+template<typename Weight>
+inline void soaBlend( const TransformSoA &a,const TransformSoA &b,Weight weight,TransformSoA &out,unsigned int begin,unsigned int end )
+{
+	soaLerp( a.px.data(),b.px.data(),weight,out.px.data(),begin,end );
+	soaLerp( a.py.data(),b.py.data(),weight,out.py.data(),begin,end );
+	soaLerp( a.pz.data(),b.pz.data(),weight,out.pz.data(),begin,end );
+	soaNlerp( a,b,weight,out,begin,end );
+	soaLerp( a.sx.data(),b.sx.data(),weight,out.sx.data(),begin,end );
+	soaLerp( a.sy.data(),b.sy.data(),weight,out.sy.data(),begin,end );
+	soaLerp( a.sz.data(),b.sz.data(),weight,out.sz.data(),begin,end );
+}
+
+// End of the whole register blocks of a pose; the masked operations run
+// the block after it (if any) from a zero padded copy of its weights.
+inline unsigned int soaFullBlocks( const PoseSoA &pose )
+{
+	return pose.Size() & ~(POSE_SOA_WIDTH - 1);
+}
+
+// out = a blended towards b by t, or by weights[i] * t per joint when masked;
+// weights holds a.Size() entries. a and b must have the same joint count.
+inline void blend( const PoseSoA &a,const PoseSoA &b,const float *weights,float t,PoseSoA &out )
+{
+	assert( a.Size() == b.Size() );
+	out.MatchLayout( a );
+	unsigned int full = soaFullBlocks( a );
+	SoaMaskedWeight weight = { weights,t };
+	soaBlend( a.GetStreams(),b.GetStreams(),weight,out.GetStreams(),0,full );
+	if ( full < a.PaddedSize() )
+	{
+		SoaTailWeight tail( weights,full,a.Size() - full,t );
+		soaBlend( a.GetStreams(),b.GetStreams(),tail,out.GetStreams(),full,a.PaddedSize() );
+	}
+}
+
+inline void blend( const PoseSoA &a,const PoseSoA &b,float t,PoseSoA &out )
+{
+	assert( a.Size() == b.Size() );
+	out.MatchLayout( a );
+	SoaWeight weight = { t };
+	soaBlend( a.GetStreams(),b.GetStreams(),weight,out.GetStreams(),0,a.PaddedSize() );
+}
+
+// Additive delta of pose relative to reference: position and scale
+// differences, rotation inverse( reference ) * pose. Reference rotations
+// must be unit length.
+inline void subtract( const PoseSoA &pose,const PoseSoA &reference,PoseSoA &out )
+{
+	assert( pose.Size() == reference.Size() );
+	const TransformSoA &a = pose.GetStreams();
+	const TransformSoA &b = reference.GetStreams();
+	out.MatchLayout( pose );
+	TransformSoA &o = out.GetStreams();
+	for ( unsigned int i = 0, n = pose.PaddedSize(); i < n; i += POSE_SOA_WIDTH )
+	{
+		float px[POSE_SOA_WIDTH],py[POSE_SOA_WIDTH],pz[POSE_SOA_WIDTH];
+		float sx[POSE_SOA_WIDTH],sy[POSE_SOA_WIDTH],sz[POSE_SOA_WIDTH];
+		float rx[POSE_SOA_WIDTH],ry[POSE_SOA_WIDTH],rz[POSE_SOA_WIDTH],rw[POSE_SOA_WIDTH];
+		for ( unsigned int k = 0; k < POSE_SOA_WIDTH; ++k )
+		{
+			unsigned int j = i + k;
+			px[k] = a.px[j] - b.px[j];
+			py[k] = a.py[j] - b.py[j];
+			pz[k] = a.pz[j] - b.pz[j];
+			sx[k] = a.sx[j] - b.sx[j];
+			sy[k] = a.sy[j] - b.sy[j];
+			sz[k] = a.sz[j] - b.sz[j];
+			// conjugate( b ) * a in quat.h's order
+			float bx = -b.rx[j], by = -b.ry[j], bz = -b.rz[j], bw = b.rw[j];
+			float ax = a.rx[j], ay = a.ry[j], az = a.rz[j], aw = a.rw[j];
+			rx[k] = bw * ax + aw * bx + (ay * bz - az * by);
+			ry[k] = bw * ay + aw * by + (az * bx - ax * bz);
+			rz[k] = bw * az + aw * bz + (ax * by - ay * bx);
+			rw[k] = bw * aw - (bx * ax + by * ay + bz * az);
+		}
+		memcpy( &o.px[i],px,sizeof( px ) ); memcpy( &o.py[i],py,sizeof( py ) ); memcpy( &o.pz[i],pz,sizeof( pz ) );
+		memcpy( &o.rx[i],rx,sizeof( rx ) ); memcpy( &o.ry[i],ry,sizeof( ry ) );
+		memcpy( &o.rz[i],rz,sizeof( rz ) ); memcpy( &o.rw[i],rw,sizeof( rw ) );
+		memcpy( &o.sx[i],sx,sizeof( sx ) ); memcpy( &o.sy[i],sy,sizeof( sy ) ); memcpy( &o.sz[i],sz,sizeof( sz ) );
+	}
+}
+
+template<typename Weight>
+inline void soaAdd( const TransformSoA &a,const TransformSoA &d,Weight weight,TransformSoA &o,unsigned int begin,unsigned int end )
+{
+	for ( unsigned int i = begin; i < end; i += POSE_SOA_WIDTH )
+	{
+		float px[POSE_SOA_WIDTH],py[POSE_SOA_WIDTH],pz[POSE_SOA_WIDTH];
+		float sx[POSE_SOA_WIDTH],sy[POSE_SOA_WIDTH],sz[POSE_SOA_WIDTH];
+		float rx[POSE_SOA_WIDTH],ry[POSE_SOA_WIDTH],rz[POSE_SOA_WIDTH],rw[POSE_SOA_WIDTH];
+		for ( unsigned int k = 0; k < POSE_SOA_WIDTH; ++k )
+		{
+			unsigned int j = i + k;
+			float wt = weight( j );
+			px[k] = a.px[j] + d.px[j] * wt;
+			py[k] = a.py[j] + d.py[j] * wt;
+			pz[k] = a.pz[j] + d.pz[j] * wt;
+			sx[k] = a.sx[j] + d.sx[j] * wt;
+			sy[k] = a.sy[j] + d.sy[j] * wt;
+			sz[k] = a.sz[j] + d.sz[j] * wt;
+			// nlerp( identity, delta, wt ) on the short arc
+			float dt = d.rw[j] < 0.0f ? -wt : wt;
+			float qx = d.rx[j] * dt, qy = d.ry[j] * dt, qz = d.rz[j] * dt;
+			float qw = (1.0f - wt) + d.rw[j] * dt;
+			float inv = 1.0f / sqrtf( qx * qx + qy * qy + qz * qz + qw * qw );
+			qx *= inv; qy *= inv; qz *= inv; qw *= inv;
+			// base * q in quat.h's order
+			float bx = a.rx[j], by = a.ry[j], bz = a.rz[j], bw = a.rw[j];
+			rx[k] = bw * qx + qw * bx + (qy * bz - qz * by);
+			ry[k] = bw * qy + qw * by + (qz * bx - qx * bz);
+			rz[k] = bw * qz + qw * bz + (qx * by - qy * bx);
+			rw[k] = bw * qw - (bx * qx + by * qy + bz * qz);
+		}
+		memcpy( &o.px[i],px,sizeof( px ) ); memcpy( &o.py[i],py,sizeof( py ) ); memcpy( &o.pz[i],pz,sizeof( pz ) );
+		memcpy( &o.rx[i],rx,sizeof( rx ) ); memcpy( &o.ry[i],ry,sizeof( ry ) );
+		memcpy( &o.rz[i],rz,sizeof( rz ) ); memcpy( &o.rw[i],rw,sizeof( rw ) );
+		memcpy( &o.sx[i],sx,sizeof( sx ) ); memcpy( &o.sy[i],sy,sizeof( sy ) ); memcpy( &o.sz[i],sz,sizeof( sz ) );
+	}
+}
+
+// out = base with delta (from subtract) layered on at weight w, or
+// weights[i] * w per joint, weights holding base.Size() entries. The delta
+// rotation is scaled along the short arc from identity, then applied after
+// the base rotation: add( b, subtract( a, b ), 1 ) == a.
+inline void add( const PoseSoA &base,const PoseSoA &delta,const float *weights,float w,PoseSoA &out )
+{
+	assert( base.Size() == delta.Size() );
+	out.MatchLayout( base );
+	unsigned int full = soaFullBlocks( base );
+	SoaMaskedWeight weight = { weights,w };
+	soaAdd( base.GetStreams(),delta.GetStreams(),weight,out.GetStreams(),0,full );
+	if ( full < base.PaddedSize() )
+	{
+		SoaTailWeight tail( weights,full,base.Size() - full,w );
+		soaAdd( base.GetStreams(),delta.GetStreams(),tail,out.GetStreams(),full,base.PaddedSize() );
+	}
+}
+
+inline void add( const PoseSoA &base,const PoseSoA &delta,float w,PoseSoA &out )
+{
+	assert( base.Size() == delta.Size() );
+	out.MatchLayout( base );
+	SoaWeight weight = { w };
+	soaAdd( base.GetStreams(),delta.GetStreams(),weight,out.GetStreams(),0,base.PaddedSize() );
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "Pose.h"
+#include "mat3x4.h"
+#include "DualQuaternion.h"
+
+// Rest pose, bind pose, joint names and the inverse bind palettes derived
+// from them. Everything is computed once in the constructor and only read
+// afterwards, so a single Skeleton can be shared by every instance of a
+// character (e.g. through a shared_ptr<const Skeleton>).
+class Skeleton
+{
+protected:
+	Pose mRestPose;
+	Pose mBindPose;
+	std::vector<mat4> mInvBindPose;
+	std::vector<mat3x4> mInvBindPose3x4;
+	std::vector<DualQuaternion> mInvBindPoseDQ;
+	std::vector<std::string> mJointNames;
+
+	void UpdateInverseBindPose()
+	{
+		// Built from the same matrix chain as the palette, so the bind pose
+		// skins to identity even under non-uniform parent scale.
+		unsigned int size = mBindPose.Size();
+		mInvBindPose.resize( size );
+		mInvBindPose3x4.resize( size );
+		mInvBindPoseDQ.resize( size );
+		GetGlobalMatrices( mBindPose,mInvBindPose.data() );
+		GetGlobalDualQuaternions( mBindPose,mInvBindPoseDQ.data() );
+		for ( unsigned int i = 0; i < size; ++i )
+		{
+			// Affine inverse, not the general 4 x 4 one.
+			mInvBindPose[i] = inverse( asAffine( mInvBindPose[i] ) ).m;
+			mInvBindPose3x4[i] = mat3x4( mInvBindPose[i] );
+			// the conjugate is the inverse of a unit dual quaternion
+			mInvBindPoseDQ[i] = conjugate( mInvBindPoseDQ[i] );
+		}
+	}
+
+	// Global matrices in one pass; parents are finished before their children.
+	static void GetGlobalMatrices( const Pose &pose,mat4 *out )
+	{
+		const int16_t *parents = pose.GetParents();
+		const Transform *local = pose.GetLocalTransforms();
+		for ( unsigned int i = 0, size = pose.Size(); i < size; ++i )
+		{
+			Affine<mat4> m = transformToMat4( local[i] );
+			out[i] = parents[i] < 0 ? m.m : (asAffine( out[parents[i]] ) * m).m;
+		}
+	}
+
+	// Scale is ignored, as dual quaternions cannot hold it.
+	static void GetGlobalDualQuaternions( const Pose &pose,DualQuaternion *out )
+	{
+		const int16_t *parents = pose.GetParents();
+		const Transform *local = pose.GetLocalTransforms();
+		for ( unsigned int i = 0, size = pose.Size(); i < size; ++i )
+		{
+			DualQuaternion dq = transformToDualQuat( local[i] );
+			out[i] = parents[i] < 0 ? dq : dq * out[parents[i]];
+		}
+	}
+public:
+	Skeleton() {}
+	// Both poses must share the same topologically sorted joint layout.
+	Skeleton( const Pose &rest,const Pose &bind,const std::vector<std::string> &names )
+		:
+		mRestPose( rest ),
+		mBindPose( bind ),
+		mJointNames( names )
+	{
+		mJointNames.resize( mBindPose.Size() );
+		UpdateInverseBindPose();
+	}
+
+	unsigned int Size() const { return mBindPose.Size(); }
+	const Pose& GetRestPose() const { return mRestPose; }
+	const Pose& GetBindPose() const { return mBindPose; }
+	const std::vector<mat4>& GetInvBindPose() const { return mInvBindPose; }
+	const std::vector<mat3x4>& GetInvBindPose3x4() const { return mInvBindPose3x4; }
+	const std::vector<DualQuaternion>& GetInvBindPoseDQ() const { return mInvBindPoseDQ; }
+	const std::vector<std::string>& GetJointNames() const { return mJointNames; }
+	const std::string& GetJointName( unsigned int index ) const { return mJointNames[index]; }
+
+	int FindJoint( const std::string &name ) const
+	{
+		for ( unsigned int i = 0, size = Size(); i < size; ++i )
+		{
+			if ( mJointNames[i] == name )
+			{
+				return (int)i;
+			}
+		}
+		return -1;
+	}
+
+	// Skinning palette: global( pose )[i] * inverseBind[i], written to out,
+	// which must hold Size() matrices. The globals are built in place first,
+	// then multiplied by the cached inverse bind matrices, so no scratch
+	// memory is needed.
+	void GetMatrixPalette( const Pose &pose,mat4 *out ) const
+	{
+		unsigned int size = Size();
+		GetGlobalMatrices( pose,out );
+		for ( unsigned int i = 0; i < size; ++i )
+		{
+			out[i] = (asAffine( out[i] ) * asAffine( mInvBindPose[i] )).m;
+		}
+	}
+
+	void GetMatrixPalette( const Pose &pose,mat3x4 *out ) const
+	{
+		unsigned int size = Size();
+		const int16_t *parents = pose.GetParents();
+		const Transform *local = pose.GetLocalTransforms();
+		for ( unsigned int i = 0; i < size; ++i )
+		{
+			mat3x4 m( transformToMat4( local[i] ).m );
+			out[i] = parents[i] < 0 ? m : out[parents[i]] * m;
+		}
+		for ( unsigned int i = 0; i < size; ++i )
+		{
+			out[i] = out[i] * mInvBindPose3x4[i];
+		}
+	}
+
+	// Same as GetMatrixPalette for skinDualQuaternion; the inverse bind is
+	// applied first, then the global joint transform. Each joint is flipped
+	// onto its parent's hemisphere (alignHemispheres) for blending.
+	void GetDualQuaternionPalette( const Pose &pose,DualQuaternion *out ) const
+	{
+		unsigned int size = Size();
+		GetGlobalDualQuaternions( pose,out );
+		for ( unsigned int i = 0; i < size; ++i )
+		{
+			out[i] = mInvBindPoseDQ[i] * out[i];
+		}
+		alignHemispheres( out,size,pose.GetParents() );
+	}
+};
@@ -0,0 +1,202 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <float.h>
+#include "vec4.h"
+
+// Packed per-vertex skin influences: 8 bit joint indices and unorm8/unorm16
+// weights. Quantized weights always sum to exactly the unorm maximum, so the
+// decoded weights add up to one with no renormalization on the skinning side.
+
+template<typename W,int N>
+struct TPackedInfluence
+{
+	uint8_t joints[N];
+	W weights[N];
+};
+
+typedef TPackedInfluence<uint8_t,4> influence4;		// 8 bytes
+typedef TPackedInfluence<uint16_t,4> influence4w16;	// 12 bytes
+typedef TPackedInfluence<uint8_t,8> influence8;		// 16 bytes
+typedef TPackedInfluence<uint16_t,8> influence8w16;	// 24 bytes
+
+#define INFLUENCE_MAX_JOINT 255
+
+template<typename W>
+struct TUnormTraits;
+
+template<>
+struct TUnormTraits<uint8_t>
+{
+	static const uint32_t max = 255u;
+};
+
+template<>
+struct TUnormTraits<uint16_t>
+{
+	static const uint32_t max = 65535u;
+};
+
+// Negative, NaN and infinite weights count as zero.
+inline float usableWeight( float w )
+{
+	return w > 0.0f && w <= FLT_MAX ? w : 0.0f;
+}
+
+// Quantizes N weights so that the integer sum is exactly the unorm maximum.
+// Rounding error is handed out by largest remainder, unusable weights are
+// treated as zero, and an all-zero input binds fully to the first slot.
+template<typename W,int N>
+void quantizeWeights( const float *in,W *out )
+{
+	const uint32_t maxq = TUnormTraits<W>::max;
+	// In double, so large finite weights cannot overflow the sum.
+	double sum = 0.0;
+	for ( int i = 0; i < N; ++i )
+	{
+		sum += usableWeight( in[i] );
+	}
+	if ( sum <= 0.0 )
+	{
+		out[0] = W( maxq );
+		for ( int i = 1; i < N; ++i )
+		{
+			out[i] = W( 0 );
+		}
+		return;
+	}
+	double scale = double( maxq ) / sum;
+	float remainder[N];
+	uint32_t total = 0;
+	for ( int i = 0; i < N; ++i )
+	{
+		float scaled = float( usableWeight( in[i] ) * scale );
+		uint32_t q = uint32_t( scaled );
+		if ( q > maxq )
+		{
+			q = maxq;
+		}
+		remainder[i] = scaled - float( q );
+		out[i] = W( q );
+		total += q;
+	}
+	while ( total < maxq )
+	{
+		int best = 0;
+		for ( int i = 1; i < N; ++i )
+		{
+			if ( remainder[i] > remainder[best] )
+			{
+				best = i;
+			}
+		}
+		out[best] = W( out[best] + 1 );
+		remainder[best] -= 1.0f;
+		++total;
+	}
+	while ( total > maxq )
+	{
+		int best = 0;
+		for ( int i = 1; i < N; ++i )
+		{
+			if ( out[i] > 0 && (out[best] == 0 || remainder[i] < remainder[best]) )
+			{
+				best = i;
+			}
+		}
+		out[best] = W( out[best] - 1 );
+		remainder[best] += 1.0f;
+		--total;
+	}
+}
+
+// Single vertex packing. Returns false if a joint index does not fit in 8 bits,
+// in which case the influence is bound to joint 0 with full weight.
+template<typename W,typename J>
+bool packInfluence( const TVec4<J> &joints,const vec4 &weights,TPackedInfluence<W,4> &out )
+{
+	for ( int i = 0; i < 4; ++i )
+	{
+		if ( (unsigned int)joints.v[i] > INFLUENCE_MAX_JOINT )
+		{
+			const float bindFirst[4] = { 1.0f,0.0f,0.0f,0.0f };
+			out.joints[0] = out.joints[1] = out.joints[2] = out.joints[3] = 0;
+			quantizeWeights<W,4>( bindFirst,out.weights );
+			return false;
+		}
+		out.joints[i] = uint8_t( joints.v[i] );
+	}
+	quantizeWeights<W,4>( weights.v,out.weights );
+	return true;
+}
+
+template<typename W,typename J>
+bool packInfluence( const TVec4<J> &jointsLo,const vec4 &weightsLo,
+	const TVec4<J> &jointsHi,const vec4 &weightsHi,TPackedInfluence<W,8> &out )
+{
+	float w[8];
+	for ( int i = 0; i < 4; ++i )
+	{
+		if ( (unsigned int)jointsLo.v[i] > INFLUENCE_MAX_JOINT ||
+			(unsigned int)jointsHi.v[i] > INFLUENCE_MAX_JOINT )
+		{
+			const float bindFirst[8] = { 1.0f,0.0f,0.0f,0.0f,0.0f,0.0f,0.0f,0.0f };
+			for ( int j = 0; j < 8; ++j )
+			{
+				out.joints[j] = 0;
+			}
+			quantizeWeights<W,8>( bindFirst,out.weights );
+			return false;
+		}
+		out.joints[i] = uint8_t( jointsLo.v[i] );
+		out.joints[i + 4] = uint8_t( jointsHi.v[i] );
+		w[i] = weightsLo.v[i];
+		w[i + 4] = weightsHi.v[i];
+	}
+	quantizeWeights<W,8>( w,out.weights );
+	return true;
+}
+
+// Bulk converters from the wide ivec4/uivec4 + vec4 layout. Every vertex is
+// written; the return value is false if any of them had an out of range joint.
+template<typename W,typename J>
+bool packInfluences( const TVec4<J> *joints,const vec4 *weights,size_t count,TPackedInfluence<W,4> *out )
+{
+	bool ok = true;
+	for ( size_t i = 0; i < count; ++i )
+	{
+		ok &= packInfluence( joints[i],weights[i],out[i] );
+	}
+	return ok;
+}
+
+template<typename W,typename J>
+bool packInfluences( const TVec4<J> *jointsLo,const vec4 *weightsLo,
+	const TVec4<J> *jointsHi,const vec4 *weightsHi,size_t count,TPackedInfluence<W,8> *out )
+{
+	bool ok = true;
+	for ( size_t i = 0; i < count; ++i )
+	{
+		ok &= packInfluence( jointsLo[i],weightsLo[i],jointsHi[i],weightsHi[i],out[i] );
+	}
+	return ok;
+}
+
+// Skinning-side decoder: joint indices as ints, weights as floats. The packed
+// weights sum to exactly the unorm maximum; the floats sum to one within rounding.
+template<typename W,int N>
+inline void decodeInfluence( const TPackedInfluence<W,N> &in,int *joints,float *weights )
+{
+	const float norm = 1.0f / float( TUnormTraits<W>::max );
+	for ( int i = 0; i < N; ++i )
+	{
+		joints[i] = in.joints[i];
+		weights[i] = float( in.weights[i] ) * norm;
+	}
+}
+
+template<typename W>
+inline void unpackInfluence( const TPackedInfluence<W,4> &in,ivec4 &joints,vec4 &weights )
+{
+	decodeInfluence( in,joints.v,weights.v );
+}
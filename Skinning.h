@@ -0,0 +1,290 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "SkinInfluence.h"
+#include "mat3x4.h"
+#include "DualQuaternion.h"
+
+// CPU linear-blend skinning against a mat3x4 palette (Skeleton::GetMatrixPalette).
+// Per vertex the weighted palette rows are summed into one 3 x 4 matrix, which
+// then transforms the position and normal. Output is one float4 per vertex
+// (w = 1 for positions, 0 for normals) so every store is a full 16 byte
+// register; normals are not renormalized.
+//
+// With streaming set and 16 byte aligned output the results bypass the cache
+// (non-temporal stores), which is what you want when the buffer is consumed
+// elsewhere (upload, another thread) rather than read back right away.
+
+#if TVEC_SSE
+// Weighted sum of the palette rows of all N influences.
+template<typename W,int N>
+inline void skinBlendRows( const TPackedInfluence<W,N> &in,const mat3x4 *palette,__m128 norm,__m128 &r0,__m128 &r1,__m128 &r2 )
+{
+	__m128 w = _mm_mul_ps( _mm_set1_ps( float( in.weights[0] ) ),norm );
+	const float *m = palette[in.joints[0]].v;
+	r0 = _mm_mul_ps( w,_mm_loadu_ps( m ) );
+	r1 = _mm_mul_ps( w,_mm_loadu_ps( m + 4 ) );
+	r2 = _mm_mul_ps( w,_mm_loadu_ps( m + 8 ) );
+	for ( int k = 1; k < N; ++k )
+	{
+		w = _mm_mul_ps( _mm_set1_ps( float( in.weights[k] ) ),norm );
+		m = palette[in.joints[k]].v;
+		r0 = _mm_add_ps( r0,_mm_mul_ps( w,_mm_loadu_ps( m ) ) );
+		r1 = _mm_add_ps( r1,_mm_mul_ps( w,_mm_loadu_ps( m + 4 ) ) );
+		r2 = _mm_add_ps( r2,_mm_mul_ps( w,_mm_loadu_ps( m + 8 ) ) );
+	}
+}
+#endif
+
+template<typename W,int N>
+inline mat3x4 skinBlendMatrix( const TPackedInfluence<W,N> &in,const mat3x4 *palette )
+{
+	const float norm = 1.0f / float( TUnormTraits<W>::max );
+	mat3x4 out;
+	for ( int c = 0; c < 12; ++c )
+	{
+		out.v[c] = 0.0f;
+	}
+	for ( int k = 0; k < N; ++k )
+	{
+		float w = float( in.weights[k] ) * norm;
+		const float *m = palette[in.joints[k]].v;
+		for ( int c = 0; c < 12; ++c )
+		{
+			out.v[c] += w * m[c];
+		}
+	}
+	return out;
+}
+
+// normals and outNormals may both be null to skin positions only.
+template<typename W,int N>
+void skinLinear( const vec3 *positions,const vec3 *normals,const TPackedInfluence<W,N> *influences,
+	const mat3x4 *palette,size_t count,vec4 *outPositions,vec4 *outNormals,bool streaming = false )
+{
+#if TVEC_SSE
+	streaming = streaming && ((uintptr_t)outPositions & 15) == 0 &&
+		(!outNormals || ((uintptr_t)outNormals & 15) == 0);
+	const __m128 norm = _mm_set1_ps( 1.0f / float( TUnormTraits<W>::max ) );
+	const __m128 pointW = _mm_set_ps( 1.0f,0.0f,0.0f,0.0f );
+	for ( size_t i = 0; i < count; ++i )
+	{
+		__m128 c0,c1,c2,c3 = _mm_setzero_ps();
+		skinBlendRows( influences[i],palette,norm,c0,c1,c2 );
+		// rows to columns; c3 becomes the translation
+		_MM_TRANSPOSE4_PS( c0,c1,c2,c3 );
+		const float *p = positions[i].v;
+		__m128 r = _mm_add_ps( _mm_add_ps( c3,pointW ),_mm_mul_ps( c0,_mm_set1_ps( p[0] ) ) );
+		r = _mm_add_ps( r,_mm_mul_ps( c1,_mm_set1_ps( p[1] ) ) );
+		r = _mm_add_ps( r,_mm_mul_ps( c2,_mm_set1_ps( p[2] ) ) );
+		if ( streaming )
+		{
+			_mm_stream_ps( outPositions[i].v,r );
+		}
+		else
+		{
+			_mm_storeu_ps( outPositions[i].v,r );
+		}
+		if ( outNormals )
+		{
+			const float *n = normals[i].v;
+			__m128 s = _mm_mul_ps( c0,_mm_set1_ps( n[0] ) );
+			s = _mm_add_ps( s,_mm_mul_ps( c1,_mm_set1_ps( n[1] ) ) );
+			s = _mm_add_ps( s,_mm_mul_ps( c2,_mm_set1_ps( n[2] ) ) );
+			if ( streaming )
+			{
+				_mm_stream_ps( outNormals[i].v,s );
+			}
+			else
+			{
+				_mm_storeu_ps( outNormals[i].v,s );
+			}
+		}
+	}
+	if ( streaming )
+	{
+		_mm_sfence();
+	}
+#else
+	(void)streaming;
+	for ( size_t i = 0; i < count; ++i )
+	{
+		mat3x4 m = skinBlendMatrix( influences[i],palette );
+		vec3 p = transformPoint( m,positions[i] );
+		outPositions[i] = vec4( p.v[0],p.v[1],p.v[2],1.0f );
+		if ( outNormals )
+		{
+			vec3 n = transformVector( m,normals[i] );
+			outNormals[i] = vec4( n.v[0],n.v[1],n.v[2],0.0f );
+		}
+	}
+#endif
+}
+
+// Dual quaternion skinning: same inputs and output as skinLinear, with one
+// normalized DualQuaternion per joint. Influences are blended as dual
+// quaternions, then renormalized. This keeps volume on twisting joints where
+// linear blending collapses.
+//
+// q and -q are the same rotation but cancel in a blend, so joints that share
+// a vertex must lie in one hemisphere. That antipodality correction is done
+// once per palette, not per vertex: Skeleton::GetDualQuaternionPalette
+// returns its palette aligned with alignHemispheres, and palettes built
+// elsewhere must go through it too.
+
+template<typename W,int N>
+inline DualQuaternion skinBlendDualQuat( const TPackedInfluence<W,N> &in,const DualQuaternion *palette )
+{
+	const float norm = 1.0f / float( TUnormTraits<W>::max );
+	DualQuaternion out = palette[in.joints[0]] * (float( in.weights[0] ) * norm);
+	for ( int k = 1; k < N; ++k )
+	{
+		out = out + palette[in.joints[k]] * (float( in.weights[k] ) * norm);
+	}
+	return normalized( out );
+}
+
+#if TVEC_SSE
+// Three packed vec3s (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) to x, y, z lanes.
+inline void skinLoadVec3x4( const vec3 *v,__m128 &x,__m128 &y,__m128 &z )
+{
+	const float *f = v[0].v;
+	__m128 a = _mm_loadu_ps( f );
+	__m128 b = _mm_loadu_ps( f + 4 );
+	__m128 c = _mm_loadu_ps( f + 8 );
+	x = _mm_shuffle_ps( a,_mm_shuffle_ps( b,c,_MM_SHUFFLE( 1,1,2,2 ) ),_MM_SHUFFLE( 2,0,3,0 ) );
+	y = _mm_shuffle_ps( _mm_shuffle_ps( a,b,_MM_SHUFFLE( 0,0,1,1 ) ),_mm_shuffle_ps( b,c,_MM_SHUFFLE( 2,2,3,3 ) ),_MM_SHUFFLE( 2,0,2,0 ) );
+	z = _mm_shuffle_ps( _mm_shuffle_ps( a,b,_MM_SHUFFLE( 1,1,2,2 ) ),_mm_shuffle_ps( c,c,_MM_SHUFFLE( 3,3,0,0 ) ),_MM_SHUFFLE( 2,0,2,0 ) );
+}
+
+inline void skinStoreVec4x4( vec4 *out,__m128 x,__m128 y,__m128 z,__m128 w,bool streaming )
+{
+	_MM_TRANSPOSE4_PS( x,y,z,w );
+	if ( streaming )
+	{
+		_mm_stream_ps( out[0].v,x );
+		_mm_stream_ps( out[1].v,y );
+		_mm_stream_ps( out[2].v,z );
+		_mm_stream_ps( out[3].v,w );
+	}
+	else
+	{
+		_mm_storeu_ps( out[0].v,x );
+		_mm_storeu_ps( out[1].v,y );
+		_mm_storeu_ps( out[2].v,z );
+		_mm_storeu_ps( out[3].v,w );
+	}
+}
+
+// r x (r x v + rw v), componentwise over four vertices.
+inline void skinRotate4( __m128 rx,__m128 ry,__m128 rz,__m128 rw,__m128 &vx,__m128 &vy,__m128 &vz )
+{
+	__m128 cx = _mm_add_ps( _mm_sub_ps( _mm_mul_ps( ry,vz ),_mm_mul_ps( rz,vy ) ),_mm_mul_ps( rw,vx ) );
+	__m128 cy = _mm_add_ps( _mm_sub_ps( _mm_mul_ps( rz,vx ),_mm_mul_ps( rx,vz ) ),_mm_mul_ps( rw,vy ) );
+	__m128 cz = _mm_add_ps( _mm_sub_ps( _mm_mul_ps( rx,vy ),_mm_mul_ps( ry,vx ) ),_mm_mul_ps( rw,vz ) );
+	vx = _mm_sub_ps( _mm_mul_ps( ry,cz ),_mm_mul_ps( rz,cy ) );
+	vy = _mm_sub_ps( _mm_mul_ps( rz,cx ),_mm_mul_ps( rx,cz ) );
+	vz = _mm_sub_ps( _mm_mul_ps( rx,cy ),_mm_mul_ps( ry,cx ) );
+}
+
+// Unnormalized blend of one vertex's influences. The unorm weights are used
+// as is, since the transform below is invariant to scaling r and d together.
+// The kernel is bound by the shuffle port, so the decoded weights are
+// broadcast from memory (a plain load) rather than with a shuffle.
+template<typename W,int N>
+inline void skinBlendDualQuat( const TPackedInfluence<W,N> &in,const DualQuaternion *palette,__m128 &r,__m128 &d )
+{
+	float weights[N];
+	for ( int k = 0; k < N; ++k )
+	{
+		weights[k] = float( in.weights[k] );
+	}
+	const float *p = palette[in.joints[0]].v;
+	__m128 w = _mm_load1_ps( weights );
+	r = _mm_mul_ps( w,_mm_loadu_ps( p ) );
+	d = _mm_mul_ps( w,_mm_loadu_ps( p + 4 ) );
+	for ( int k = 1; k < N; ++k )
+	{
+		p = palette[in.joints[k]].v;
+		w = _mm_load1_ps( weights + k );
+		r = _mm_add_ps( r,_mm_mul_ps( w,_mm_loadu_ps( p ) ) );
+		d = _mm_add_ps( d,_mm_mul_ps( w,_mm_loadu_ps( p + 4 ) ) );
+	}
+}
+#endif
+
+// Four vertices per iteration: each vertex is blended on its own, then the
+// four blended dual quaternions are transposed so normalization and the
+// transform run one vertex per SIMD lane. Normalization is folded into a
+// single 2 / |r|^2 factor, since rotation and translation are both quadratic
+// in the blended quaternion. The last count % 4 vertices go through the
+// scalar path.
+template<typename W,int N>
+void skinDualQuaternion( const vec3 *positions,const vec3 *normals,const TPackedInfluence<W,N> *influences,
+	const DualQuaternion *palette,size_t count,vec4 *outPositions,vec4 *outNormals,bool streaming = false )
+{
+	size_t i = 0;
+#if TVEC_SSE
+	streaming = streaming && ((uintptr_t)outPositions & 15) == 0 &&
+		(!outNormals || ((uintptr_t)outNormals & 15) == 0);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 two = _mm_set1_ps( 2.0f );
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		__m128 rx,ry,rz,rw,dx,dy,dz,dw;
+		skinBlendDualQuat( influences[i],palette,rx,dx );
+		skinBlendDualQuat( influences[i + 1],palette,ry,dy );
+		skinBlendDualQuat( influences[i + 2],palette,rz,dz );
+		skinBlendDualQuat( influences[i + 3],palette,rw,dw );
+		_MM_TRANSPOSE4_PS( rx,ry,rz,rw );
+		_MM_TRANSPOSE4_PS( dx,dy,dz,dw );
+		__m128 lenSq = _mm_add_ps( _mm_add_ps( _mm_mul_ps( rx,rx ),_mm_mul_ps( ry,ry ) ),
+			_mm_add_ps( _mm_mul_ps( rz,rz ),_mm_mul_ps( rw,rw ) ) );
+		__m128 s = _mm_div_ps( two,lenSq );
+		// translation 2 (rw d - dw r + r x d) / |r|^2
+		__m128 tx = _mm_sub_ps( _mm_mul_ps( rw,dx ),_mm_mul_ps( dw,rx ) );
+		__m128 ty = _mm_sub_ps( _mm_mul_ps( rw,dy ),_mm_mul_ps( dw,ry ) );
+		__m128 tz = _mm_sub_ps( _mm_mul_ps( rw,dz ),_mm_mul_ps( dw,rz ) );
+		tx = _mm_mul_ps( s,_mm_add_ps( tx,_mm_sub_ps( _mm_mul_ps( ry,dz ),_mm_mul_ps( rz,dy ) ) ) );
+		ty = _mm_mul_ps( s,_mm_add_ps( ty,_mm_sub_ps( _mm_mul_ps( rz,dx ),_mm_mul_ps( rx,dz ) ) ) );
+		tz = _mm_mul_ps( s,_mm_add_ps( tz,_mm_sub_ps( _mm_mul_ps( rx,dy ),_mm_mul_ps( ry,dx ) ) ) );
+		// rotation v + 2 r x (r x v + rw v) / |r|^2
+		__m128 vx,vy,vz,ux,uy,uz;
+		skinLoadVec3x4( positions + i,vx,vy,vz );
+		ux = vx; uy = vy; uz = vz;
+		skinRotate4( rx,ry,rz,rw,ux,uy,uz );
+		vx = _mm_add_ps( _mm_add_ps( vx,tx ),_mm_mul_ps( s,ux ) );
+		vy = _mm_add_ps( _mm_add_ps( vy,ty ),_mm_mul_ps( s,uy ) );
+		vz = _mm_add_ps( _mm_add_ps( vz,tz ),_mm_mul_ps( s,uz ) );
+		skinStoreVec4x4( outPositions + i,vx,vy,vz,one,streaming );
+		if ( outNormals )
+		{
+			skinLoadVec3x4( normals + i,vx,vy,vz );
+			ux = vx; uy = vy; uz = vz;
+			skinRotate4( rx,ry,rz,rw,ux,uy,uz );
+			vx = _mm_add_ps( vx,_mm_mul_ps( s,ux ) );
+			vy = _mm_add_ps( vy,_mm_mul_ps( s,uy ) );
+			vz = _mm_add_ps( vz,_mm_mul_ps( s,uz ) );
+			skinStoreVec4x4( outNormals + i,vx,vy,vz,zero,streaming );
+		}
+	}
+	if ( streaming )
+	{
+		_mm_sfence();
+	}
+#else
+	(void)streaming;
+#endif
+	for ( ; i < count; ++i )
+	{
+		DualQuaternion dq = skinBlendDualQuat( influences[i],palette );
+		vec3 p = transformPoint( dq,positions[i] );
+		outPositions[i] = vec4( p.v[0],p.v[1],p.v[2],1.0f );
+		if ( outNormals )
+		{
+			vec3 n = transformVector( dq,normals[i] );
+			outNormals[i] = vec4( n.v[0],n.v[1],n.v[2],0.0f );
+		}
+	}
+}
@@ -0,0 +1,260 @@
+#pragma once
+#include "TVec.h"
+
+// Generic R x C matrix core, column major: element (row r, column c) is
+// v[c * R + r]. As with TVec the v[] array is the storage every kernel works
+// on, specializations may add named union views on top of it.
+
+template<typename T,int R,int C>
+struct TMat
+{
+	typedef T value_type;
+	static const int rows = R;
+	static const int cols = C;
+	T v[R * C];
+	constexpr TMat() : v() {};
+	constexpr TMat( const T *fv ) : v()
+	{
+		for ( int i = 0; i < R * C; ++i )
+		{
+			v[i] = fv[i];
+		}
+	};
+	constexpr T& at( int r,int c ) { return v[c * R + r]; }
+	constexpr const T& at( int r,int c ) const { return v[c * R + r]; }
+	constexpr TVec<T,R> column( int c ) const { return TVec<T,R>( v + c * R ); }
+};
+
+// 4 x 4 specialization with the named views mat4 has always exposed.
+template<typename T>
+struct TMat<T,4,4>
+{
+	typedef T value_type;
+	static const int rows = 4;
+	static const int cols = 4;
+	union
+	{
+		T v[16];
+		struct
+		{
+			TVec<T,4> right;
+			TVec<T,4> up;
+			TVec<T,4> forward;
+			TVec<T,4> position;
+		};
+		struct
+		{
+			//		col0	  col1      col2      col3
+			/*row0*/T xx; T xy; T xz; T xw;
+			/*row1*/T yx; T yy; T yz; T yw;
+			/*row2*/T zx; T zy; T zz; T zw;
+			/*row3*/T tx; T ty; T tz; T tw;
+		};
+		struct
+		{
+			T c0r0; T c1r0; T c2r0; T c3r0;
+			T c0r1; T c1r1; T c2r1; T c3r1;
+			T c0r2; T c1r2; T c2r2; T c3r2;
+			T c0r3; T c1r3; T c2r3; T c3r3;
+		};
+		struct
+		{
+			T r0c0; T r0c1; T r0c2; T r0c3;
+			T r1c0; T r1c1; T r1c2; T r1c3;
+			T r2c0; T r2c1; T r2c2; T r2c3;
+			T r3c0; T r3c1; T r3c2; T r3c3;
+		};
+	}; //end union
+	constexpr TMat() : v() {};
+	constexpr TMat( const T *fv )
+		:
+		v{ fv[0],fv[1],fv[2],fv[3],
+		fv[4],fv[5],fv[6],fv[7],
+		fv[8],fv[9],fv[10],fv[11],
+		fv[12],fv[13],fv[14],fv[15] }
+	{};
+	constexpr TMat(
+		T _00,T _01,T _02,T _03,
+		T _10,T _11,T _12,T _13,
+		T _20,T _21,T _22,T _23,
+		T _30,T _31,T _32,T _33 )
+		:
+		v{ _00,_01,_02,_03,
+		_10,_11,_12,_13,
+		_20,_21,_22,_23,
+		_30,_31,_32,_33 }
+	{};
+	constexpr TMat( const TVec<T,4> &a,const TVec<T,4> &b,const TVec<T,4> &c,const TVec<T,4> &d )
+		:
+		v{ a.v[0],a.v[1],a.v[2],a.v[3],
+		b.v[0],b.v[1],b.v[2],b.v[3],
+		c.v[0],c.v[1],c.v[2],c.v[3],
+		d.v[0],d.v[1],d.v[2],d.v[3] }
+	{};
+	constexpr T& at( int r,int c ) { return v[c * 4 + r]; }
+	constexpr const T& at( int r,int c ) const { return v[c * 4 + r]; }
+	constexpr TVec<T,4> column( int c ) const { return TVec<T,4>( v + c * 4 ); }
+};
+
+template<typename T,int R,int K,int C>
+struct TMatOps
+{
+	static constexpr TMat<T,R,C> mul( const TMat<T,R,K> &a,const TMat<T,K,C> &b )
+	{
+		TMat<T,R,C> r;
+		for ( int c = 0; c < C; ++c )
+		{
+			for ( int row = 0; row < R; ++row )
+			{
+				T sum = a.v[0 * R + row] * b.v[c * K + 0];
+				for ( int k = 1; k < K; ++k )
+				{
+					sum += a.v[k * R + row] * b.v[c * K + k];
+				}
+				r.v[c * R + row] = sum;
+			}
+		}
+		return r;
+	}
+};
+
+template<typename T,int R,int C>
+struct TMatVecOps
+{
+	static constexpr TVec<T,R> mul( const TMat<T,R,C> &a,const TVec<T,C> &b )
+	{
+		TVec<T,R> r;
+		for ( int row = 0; row < R; ++row )
+		{
+			T sum = a.v[0 * R + row] * b.v[0];
+			for ( int k = 1; k < C; ++k )
+			{
+				sum += a.v[k * R + row] * b.v[k];
+			}
+			r.v[row] = sum;
+		}
+		return r;
+	}
+};
+
+#if TVEC_SSE
+// Column-major 4 x 4 products as a linear combination of a's columns.
+template<>
+struct TMatVecOps<float,4,4>
+{
+	static constexpr TVec<float,4> mul( const TMat<float,4,4> &a,const TVec<float,4> &b )
+	{
+		if ( !TVEC_IS_CONSTANT_EVALUATED() )
+		{
+			__m128 r = _mm_mul_ps( _mm_loadu_ps( a.v ),_mm_set1_ps( b.v[0] ) );
+			r = _mm_add_ps( r,_mm_mul_ps( _mm_loadu_ps( a.v + 4 ),_mm_set1_ps( b.v[1] ) ) );
+			r = _mm_add_ps( r,_mm_mul_ps( _mm_loadu_ps( a.v + 8 ),_mm_set1_ps( b.v[2] ) ) );
+			r = _mm_add_ps( r,_mm_mul_ps( _mm_loadu_ps( a.v + 12 ),_mm_set1_ps( b.v[3] ) ) );
+			TVec<float,4> out;
+			_mm_storeu_ps( out.v,r );
+			return out;
+		}
+		TVec<float,4> r;
+		for ( int row = 0; row < 4; ++row )
+		{
+			r.v[row] = a.v[row] * b.v[0] + a.v[4 + row] * b.v[1] + a.v[8 + row] * b.v[2] + a.v[12 + row] * b.v[3];
+		}
+		return r;
+	}
+};
+
+template<>
+struct TMatOps<float,4,4,4>
+{
+	static constexpr TMat<float,4,4> mul( const TMat<float,4,4> &a,const TMat<float,4,4> &b )
+	{
+		if ( !TVEC_IS_CONSTANT_EVALUATED() )
+		{
+			__m128 c0 = _mm_loadu_ps( a.v );
+			__m128 c1 = _mm_loadu_ps( a.v + 4 );
+			__m128 c2 = _mm_loadu_ps( a.v + 8 );
+			__m128 c3 = _mm_loadu_ps( a.v + 12 );
+			TMat<float,4,4> out;
+			for ( int c = 0; c < 4; ++c )
+			{
+				const float *bc = b.v + c * 4;
+				__m128 r = _mm_mul_ps( c0,_mm_set1_ps( bc[0] ) );
+				r = _mm_add_ps( r,_mm_mul_ps( c1,_mm_set1_ps( bc[1] ) ) );
+				r = _mm_add_ps( r,_mm_mul_ps( c2,_mm_set1_ps( bc[2] ) ) );
+				r = _mm_add_ps( r,_mm_mul_ps( c3,_mm_set1_ps( bc[3] ) ) );
+				_mm_storeu_ps( out.v + c * 4,r );
+			}
+			return out;
+		}
+		TMat<float,4,4> r;
+		for ( int c = 0; c < 4; ++c )
+		{
+			for ( int row = 0; row < 4; ++row )
+			{
+				r.v[c * 4 + row] = a.v[row] * b.v[c * 4] + a.v[4 + row] * b.v[c * 4 + 1] +
+					a.v[8 + row] * b.v[c * 4 + 2] + a.v[12 + row] * b.v[c * 4 + 3];
+			}
+		}
+		return r;
+	}
+};
+#endif
+
+template<typename T,int R,int C>
+constexpr TMat<T,R,C> operator+( const TMat<T,R,C> &a,const TMat<T,R,C> &b )
+{
+	TMat<T,R,C> r;
+	for ( int i = 0; i < R * C; ++i )
+	{
+		r.v[i] = a.v[i] + b.v[i];
+	}
+	return r;
+}
+
+template<typename T,int R,int C>
+constexpr TMat<T,R,C> operator-( const TMat<T,R,C> &a,const TMat<T,R,C> &b )
+{
+	TMat<T,R,C> r;
+	for ( int i = 0; i < R * C; ++i )
+	{
+		r.v[i] = a.v[i] - b.v[i];
+	}
+	return r;
+}
+
+template<typename T,int R,int C,typename S,typename = typename TScalarOperand<S,T>::type>
+constexpr TMat<T,R,C> operator*( const TMat<T,R,C> &m,S s )
+{
+	TMat<T,R,C> r;
+	for ( int i = 0; i < R * C; ++i )
+	{
+		r.v[i] = m.v[i] * T( s );
+	}
+	return r;
+}
+
+template<typename T,int R,int K,int C>
+constexpr TMat<T,R,C> operator*( const TMat<T,R,K> &a,const TMat<T,K,C> &b )
+{
+	return TMatOps<T,R,K,C>::mul( a,b );
+}
+
+template<typename T,int R,int C>
+constexpr TVec<T,R> operator*( const TMat<T,R,C> &a,const TVec<T,C> &b )
+{
+	return TMatVecOps<T,R,C>::mul( a,b );
+}
+
+template<typename T,int R,int C>
+constexpr TMat<T,C,R> transposed( const TMat<T,R,C> &m )
+{
+	TMat<T,C,R> r;
+	for ( int c = 0; c < C; ++c )
+	{
+		for ( int row = 0; row < R; ++row )
+		{
+			r.v[row * C + c] = m.v[c * R + row];
+		}
+	}
+	return r;
+}
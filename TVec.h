@@ -0,0 +1,286 @@
+#pragma once
+#include <math.h>
+#include <type_traits>
+
+// Generic vector core. Storage is always the v[] array; x/y/z/w are union
+// views over it for the 2, 3 and 4 component specializations. Everything in
+// the core reads and writes through v[], so all of it is usable in constant
+// expressions. The float x 4 operations have an SSE path that is only taken
+// at runtime.
+
+#if defined(_M_X64) || defined(__SSE__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TVEC_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#if defined(__cpp_lib_is_constant_evaluated)
+#define TVEC_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#else
+#define TVEC_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+
+// Scalar operand S of a T vector or matrix operator, converted to T. Float
+// vectors take any arithmetic type (vec3 * 2, vec3 * 0.5); integer vectors
+// only integers, so ivec4 * 0.5f fails to compile instead of being ivec4 * 0.
+template<typename S,typename T>
+struct TScalarOperand : std::enable_if<std::is_arithmetic<S>::value &&
+	(std::is_floating_point<T>::value || std::is_integral<S>::value),T>
+{
+};
+
+template<typename T,int N>
+struct TVec
+{
+	typedef T value_type;
+	static const int size = N;
+	T v[N];
+	constexpr TVec() : v() {};
+	constexpr TVec( const T *fv ) : v()
+	{
+		for ( int i = 0; i < N; ++i )
+		{
+			v[i] = fv[i];
+		}
+	};
+	constexpr T& operator[]( int i ) { return v[i]; }
+	constexpr const T& operator[]( int i ) const { return v[i]; }
+};
+
+template<typename T>
+struct TVec<T,2>
+{
+	typedef T value_type;
+	static const int size = 2;
+	union
+	{
+		struct
+		{
+			T x;
+			T y;
+		};
+		T v[2];
+	};
+	constexpr TVec() : v{ T( 0 ),T( 0 ) } {};
+	constexpr TVec( T _x,T _y ) : v{ _x,_y } {};
+	constexpr TVec( const T *fv ) : v{ fv[0],fv[1] } {};
+	constexpr T& operator[]( int i ) { return v[i]; }
+	constexpr const T& operator[]( int i ) const { return v[i]; }
+};
+
+template<typename T>
+struct TVec<T,3>
+{
+	typedef T value_type;
+	static const int size = 3;
+	union
+	{
+		struct
+		{
+			T x;
+			T y;
+			T z;
+		};
+		T v[3];
+	};
+	constexpr TVec() : v{ T( 0 ),T( 0 ),T( 0 ) } {};
+	constexpr TVec( T _x,T _y,T _z ) : v{ _x,_y,_z } {};
+	constexpr TVec( const T *fv ) : v{ fv[0],fv[1],fv[2] } {};
+	constexpr T& operator[]( int i ) { return v[i]; }
+	constexpr const T& operator[]( int i ) const { return v[i]; }
+};
+
+template<typename T>
+struct TVec<T,4>
+{
+	typedef T value_type;
+	static const int size = 4;
+	union
+	{
+		struct
+		{
+			T x;
+			T y;
+			T z;
+			T w;
+		};
+		T v[4];
+	};
+	constexpr TVec() : v{ T( 0 ),T( 0 ),T( 0 ),T( 0 ) } {};
+	constexpr TVec( T _x,T _y,T _z,T _w ) : v{ _x,_y,_z,_w } {};
+	constexpr TVec( const T *fv ) : v{ fv[0],fv[1],fv[2],fv[3] } {};
+	constexpr T& operator[]( int i ) { return v[i]; }
+	constexpr const T& operator[]( int i ) const { return v[i]; }
+};
+
+// Component-wise kernels. Operators below forward here so that a single
+// specialization swaps in the SIMD version for every operator at once.
+template<typename T,int N>
+struct TVecOps
+{
+	static constexpr TVec<T,N> add( const TVec<T,N> &a,const TVec<T,N> &b )
+	{
+		TVec<T,N> r;
+		for ( int i = 0; i < N; ++i )
+		{
+			r.v[i] = a.v[i] + b.v[i];
+		}
+		return r;
+	}
+	static constexpr TVec<T,N> sub( const TVec<T,N> &a,const TVec<T,N> &b )
+	{
+		TVec<T,N> r;
+		for ( int i = 0; i < N; ++i )
+		{
+			r.v[i] = a.v[i] - b.v[i];
+		}
+		return r;
+	}
+	static constexpr TVec<T,N> mul( const TVec<T,N> &a,const TVec<T,N> &b )
+	{
+		TVec<T,N> r;
+		for ( int i = 0; i < N; ++i )
+		{
+			r.v[i] = a.v[i] * b.v[i];
+		}
+		return r;
+	}
+	static constexpr TVec<T,N> scale( const TVec<T,N> &a,T s )
+	{
+		TVec<T,N> r;
+		for ( int i = 0; i < N; ++i )
+		{
+			r.v[i] = a.v[i] * s;
+		}
+		return r;
+	}
+	static constexpr T dot( const TVec<T,N> &a,const TVec<T,N> &b )
+	{
+		T r = a.v[0] * b.v[0];
+		for ( int i = 1; i < N; ++i )
+		{
+			r += a.v[i] * b.v[i];
+		}
+		return r;
+	}
+};
+
+#if TVEC_SSE
+template<>
+struct TVecOps<float,4>
+{
+	static constexpr TVec<float,4> add( const TVec<float,4> &a,const TVec<float,4> &b )
+	{
+		if ( !TVEC_IS_CONSTANT_EVALUATED() )
+		{
+			TVec<float,4> r;
+			_mm_storeu_ps( r.v,_mm_add_ps( _mm_loadu_ps( a.v ),_mm_loadu_ps( b.v ) ) );
+			return r;
+		}
+		return TVec<float,4>( a.v[0] + b.v[0],a.v[1] + b.v[1],a.v[2] + b.v[2],a.v[3] + b.v[3] );
+	}
+	static constexpr TVec<float,4> sub( const TVec<float,4> &a,const TVec<float,4> &b )
+	{
+		if ( !TVEC_IS_CONSTANT_EVALUATED() )
+		{
+			TVec<float,4> r;
+			_mm_storeu_ps( r.v,_mm_sub_ps( _mm_loadu_ps( a.v ),_mm_loadu_ps( b.v ) ) );
+			return r;
+		}
+		return TVec<float,4>( a.v[0] - b.v[0],a.v[1] - b.v[1],a.v[2] - b.v[2],a.v[3] - b.v[3] );
+	}
+	static constexpr TVec<float,4> mul( const TVec<float,4> &a,const TVec<float,4> &b )
+	{
+		if ( !TVEC_IS_CONSTANT_EVALUATED() )
+		{
+			TVec<float,4> r;
+			_mm_storeu_ps( r.v,_mm_mul_ps( _mm_loadu_ps( a.v ),_mm_loadu_ps( b.v ) ) );
+			return r;
+		}
+		return TVec<float,4>( a.v[0] * b.v[0],a.v[1] * b.v[1],a.v[2] * b.v[2],a.v[3] * b.v[3] );
+	}
+	static constexpr TVec<float,4> scale( const TVec<float,4> &a,float s )
+	{
+		if ( !TVEC_IS_CONSTANT_EVALUATED() )
+		{
+			TVec<float,4> r;
+			_mm_storeu_ps( r.v,_mm_mul_ps( _mm_loadu_ps( a.v ),_mm_set1_ps( s ) ) );
+			return r;
+		}
+		return TVec<float,4>( a.v[0] * s,a.v[1] * s,a.v[2] * s,a.v[3] * s );
+	}
+	static constexpr float dot( const TVec<float,4> &a,const TVec<float,4> &b )
+	{
+		if ( !TVEC_IS_CONSTANT_EVALUATED() )
+		{
+			__m128 m = _mm_mul_ps( _mm_loadu_ps( a.v ),_mm_loadu_ps( b.v ) );
+			__m128 s = _mm_add_ps( m,_mm_movehl_ps( m,m ) );
+			s = _mm_add_ss( s,_mm_shuffle_ps( s,s,_MM_SHUFFLE( 1,1,1,1 ) ) );
+			return _mm_cvtss_f32( s );
+		}
+		return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.v[3] * b.v[3];
+	}
+};
+#endif
+
+template<typename T,int N>
+constexpr TVec<T,N> operator+( const TVec<T,N> &lhs,const TVec<T,N> &rhs )
+{
+	return TVecOps<T,N>::add( lhs,rhs );
+}
+
+template<typename T,int N>
+constexpr TVec<T,N> operator-( const TVec<T,N> &lhs,const TVec<T,N> &rhs )
+{
+	return TVecOps<T,N>::sub( lhs,rhs );
+}
+
+template<typename T,int N>
+constexpr TVec<T,N> operator-( const TVec<T,N> &v )
+{
+	return TVecOps<T,N>::scale( v,T( -1 ) );
+}
+
+template<typename T,int N>
+constexpr TVec<T,N> operator*( const TVec<T,N> &lhs,const TVec<T,N> &rhs )
+{
+	return TVecOps<T,N>::mul( lhs,rhs );
+}
+
+template<typename T,int N,typename S,typename = typename TScalarOperand<S,T>::type>
+constexpr TVec<T,N> operator*( const TVec<T,N> &v,S s )
+{
+	return TVecOps<T,N>::scale( v,T( s ) );
+}
+
+template<typename T,int N,typename S,typename = typename TScalarOperand<S,T>::type>
+constexpr TVec<T,N> operator*( S s,const TVec<T,N> &v )
+{
+	return TVecOps<T,N>::scale( v,T( s ) );
+}
+
+template<typename T,int N>
+constexpr TVec<T,N>& operator+=( TVec<T,N> &lhs,const TVec<T,N> &rhs )
+{
+	lhs = lhs + rhs;
+	return lhs;
+}
+
+template<typename T,int N>
+constexpr TVec<T,N>& operator-=( TVec<T,N> &lhs,const TVec<T,N> &rhs )
+{
+	lhs = lhs - rhs;
+	return lhs;
+}
+
+template<typename T,int N,typename S,typename = typename TScalarOperand<S,T>::type>
+constexpr TVec<T,N>& operator*=( TVec<T,N> &lhs,S s )
+{
+	lhs = lhs * T( s );
+	return lhs;
+}
+
+template<typename T,int N>
+constexpr T dot( const TVec<T,N> &lhs,const TVec<T,N> &rhs )
+{
+	return TVecOps<T,N>::dot( lhs,rhs );
+}
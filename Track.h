@@ -0,0 +1,184 @@
+#pragma once
+#include <vector>
+#include <math.h>
+#include "Frame.h"
+#include "Interpolation.h"
+#include "Vec3.h"
+#include "quat.h"
+
+// Per value type glue for Track: building a value from a frame's floats and
+// the handful of operations where quaternions differ from plain vectors.
+template<typename T>
+struct TTrackValue;
+
+template<>
+struct TTrackValue<float>
+{
+	static float cast( const float *v ) { return v[0]; }
+	static float raw( const float *v ) { return v[0]; }
+	static float interpolate( float a,float b,float t ) { return a + (b - a) * t; }
+	static void neighborhood( const float &,float & ) {}
+	static float adjustHermite( float f ) { return f; }
+};
+
+template<>
+struct TTrackValue<vec3>
+{
+	static vec3 cast( const float *v ) { return vec3( v ); }
+	static vec3 raw( const float *v ) { return vec3( v ); }
+	static vec3 interpolate( const vec3 &a,const vec3 &b,float t ) { return lerp( a,b,t ); }
+	static void neighborhood( const vec3 &,vec3 & ) {}
+	static vec3 adjustHermite( const vec3 &v ) { return v; }
+};
+
+template<>
+struct TTrackValue<quat>
+{
+	static quat cast( const float *v ) { return normalized( quat( v[0],v[1],v[2],v[3] ) ); }
+	static quat raw( const float *v ) { return quat( v[0],v[1],v[2],v[3] ); }
+	// Neighborhooded nlerp: flip b onto a's hemisphere to take the short arc.
+	static quat interpolate( const quat &a,const quat &b,float t )
+	{
+		return nlerp( a,dot( a,b ) < 0 ? -b : b,t );
+	}
+	static void neighborhood( const quat &a,quat &b )
+	{
+		if ( dot( a,b ) < 0 )
+		{
+			b = -b;
+		}
+	}
+	static quat adjustHermite( const quat &q ) { return normalized( q ); }
+};
+
+// Keyframed animation curve. Frames must be sorted by time. Sampling never
+// allocates: it maps the time into the track, finds the segment and
+// evaluates it. The three steps are public so other key lookups can reuse
+// the segment evaluation.
+template<typename T,int N>
+class Track
+{
+protected:
+	std::vector<Frame<N>> mFrames;
+	Interpolation mInterpolation;
+public:
+	typedef T value_type;
+	static const int components = N;
+	Track() : mInterpolation( Interpolation::Linear ) {}
+	void Resize( unsigned int size ) { mFrames.resize( size ); }
+	unsigned int Size() const { return (unsigned int)mFrames.size(); }
+	Interpolation GetInterpolation() const { return mInterpolation; }
+	void SetInterpolation( Interpolation interp ) { mInterpolation = interp; }
+	float GetStartTime() const { return mFrames.empty() ? 0.0f : mFrames.front().mTime; }
+	float GetEndTime() const { return mFrames.empty() ? 0.0f : mFrames.back().mTime; }
+	Frame<N>& operator[]( unsigned int index ) { return mFrames[index]; }
+	const Frame<N>& operator[]( unsigned int index ) const { return mFrames[index]; }
+	const Frame<N>* Frames() const { return mFrames.data(); }
+
+	T Sample( float time,bool looping ) const
+	{
+		if ( mFrames.empty() )
+		{
+			return T();
+		}
+		float t = AdjustTimeToFitTrack( time,looping );
+		return SampleSegment( FrameIndex( t ),t );
+	}
+
+	// Wraps (looping) or clamps the time into [start, end].
+	float AdjustTimeToFitTrack( float time,bool looping ) const
+	{
+		if ( mFrames.size() <= 1 )
+		{
+			return GetStartTime();
+		}
+		float start = mFrames.front().mTime;
+		float end = mFrames.back().mTime;
+		float duration = end - start;
+		if ( duration <= 0.0f )
+		{
+			return start;
+		}
+		if ( looping )
+		{
+			time = fmodf( time - start,duration );
+			if ( time < 0.0f )
+			{
+				time += duration;
+			}
+			return time + start;
+		}
+		return time < start ? start : (time > end ? end : time);
+	}
+
+	// Binary search for the segment [i, i + 1] containing an adjusted time,
+	// clamped to [0, Size() - 2]. Returns -1 for tracks with fewer than 2 keys.
+	int FrameIndex( float time ) const
+	{
+		int size = (int)mFrames.size();
+		if ( size <= 1 )
+		{
+			return -1;
+		}
+		int lo = 0;
+		int count = size - 1;
+		while ( count > 1 )
+		{
+			int half = count / 2;
+			if ( mFrames[lo + half].mTime <= time )
+			{
+				lo += half;
+				count -= half;
+			}
+			else
+			{
+				count = half;
+			}
+		}
+		return lo;
+	}
+
+	// Evaluates the segment starting at frame with an already adjusted time.
+	T SampleSegment( int frame,float time ) const
+	{
+		if ( frame < 0 )
+		{
+			return mFrames.empty() ? T() : TTrackValue<T>::cast( mFrames[0].mValue );
+		}
+		const Frame<N> &f0 = mFrames[frame];
+		const Frame<N> &f1 = mFrames[frame + 1];
+		float delta = f1.mTime - f0.mTime;
+		if ( mInterpolation == Interpolation::Constant || delta <= 0.0f )
+		{
+			return TTrackValue<T>::cast( time >= f1.mTime ? f1.mValue : f0.mValue );
+		}
+		float t = (time - f0.mTime) / delta;
+		t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+		if ( mInterpolation == Interpolation::Linear )
+		{
+			return TTrackValue<T>::interpolate( TTrackValue<T>::cast( f0.mValue ),TTrackValue<T>::cast( f1.mValue ),t );
+		}
+		// Tangents are stored per second, Hermite wants them per segment.
+		return Hermite( t,
+			TTrackValue<T>::cast( f0.mValue ),TTrackValue<T>::raw( f0.mOut ) * delta,
+			TTrackValue<T>::cast( f1.mValue ),TTrackValue<T>::raw( f1.mIn ) * delta );
+	}
+
+	static T Hermite( float t,const T &p1,const T &s1,const T &_p2,const T &s2 )
+	{
+		float tt = t * t;
+		float ttt = tt * t;
+		T p2 = _p2;
+		TTrackValue<T>::neighborhood( p1,p2 );
+		float h1 = 2.0f * ttt - 3.0f * tt + 1.0f;
+		float h2 = -2.0f * ttt + 3.0f * tt;
+		float h3 = ttt - 2.0f * tt + t;
+		float h4 = ttt - tt;
+		T result = p1 * h1 + p2 * h2 + s1 * h3 + s2 * h4;
+		return TTrackValue<T>::adjustHermite( result );
+	}
+};
+
+typedef Track<float,1> ScalarTrack;
+typedef Track<vec3,3> VectorTrack;
+typedef Track<quat,4> QuaternionTrack;
@@ -0,0 +1,190 @@
+#pragma once
+#include <vector>
+#include <stdlib.h>
+#include "Benchmark.h"
+#include "Track.h"
+#include "FastTrack.h"
+#include "PolynomialTrack.h"
+#include "TrackCursor.h"
+#include "KeySearch.h"
+
+// Track sampling throughput. Tracks are filled with deterministic
+// pseudo-random keys and sampled at times spread over one and a half loops.
+
+template<typename T,int N>
+void fillBenchmarkTrack( Track<T,N> &track,unsigned int keys,float fps,Interpolation interp )
+{
+	srand( 1234 );
+	track.Resize( keys );
+	track.SetInterpolation( interp );
+	for ( unsigned int i = 0; i < keys; ++i )
+	{
+		Frame<N> &f = track[i];
+		f.mTime = float( i ) / fps;
+		for ( int c = 0; c < N; ++c )
+		{
+			f.mValue[c] = float( rand() ) / float( RAND_MAX ) * 2.0f - 1.0f;
+			f.mIn[c] = float( rand() ) / float( RAND_MAX ) - 0.5f;
+			f.mOut[c] = f.mIn[c];
+		}
+	}
+}
+
+inline std::vector<float> benchmarkSampleTimes( unsigned int count,float duration )
+{
+	std::vector<float> times( count );
+	for ( unsigned int i = 0; i < count; ++i )
+	{
+		times[i] = float( rand() ) / float( RAND_MAX ) * duration * 1.5f;
+	}
+	return times;
+}
+
+template<typename T>
+float benchmarkReduce( const T &v ) { return *(const float*)&v; }
+
+template<typename TRACK>
+BenchmarkResult benchmarkTrack( const char *name,const TRACK &track,const std::vector<float> &times )
+{
+	return runBenchmark( name,double( times.size() ),[&]()
+	{
+		float acc = 0.0f;
+		for ( size_t i = 0; i < times.size(); ++i )
+		{
+			acc += benchmarkReduce( track.Sample( times[i],true ) );
+		}
+		benchmarkSink() = acc;
+	} );
+}
+
+// Samples per second for every value type and interpolation mode.
+inline void benchmarkTrackSampling( unsigned int keys = 120,unsigned int samples = 1000000 )
+{
+	const char *names[3][3] = {
+		{ "scalar constant","scalar linear","scalar cubic" },
+		{ "vec3 constant","vec3 linear","vec3 cubic" },
+		{ "quat constant","quat linear","quat cubic" } };
+	const Interpolation modes[3] = { Interpolation::Constant,Interpolation::Linear,Interpolation::Cubic };
+	std::vector<float> times = benchmarkSampleTimes( samples,float( keys - 1 ) / 30.0f );
+	for ( int m = 0; m < 3; ++m )
+	{
+		ScalarTrack s;
+		VectorTrack v;
+		QuaternionTrack q;
+		fillBenchmarkTrack( s,keys,30.0f,modes[m] );
+		fillBenchmarkTrack( v,keys,30.0f,modes[m] );
+		fillBenchmarkTrack( q,keys,30.0f,modes[m] );
+		printBenchmark( benchmarkTrack( names[0][m],s,times ),"samples" );
+		printBenchmark( benchmarkTrack( names[1][m],v,times ),"samples" );
+		printBenchmark( benchmarkTrack( names[2][m],q,times ),"samples" );
+	}
+}
+
+// Binary search against lookup tables at several rates, with the table size.
+inline void benchmarkFastTrackSampling( unsigned int keys = 1800,unsigned int samples = 1000000 )
+{
+	const float rates[4] = { 15.0f,30.0f,60.0f,120.0f };
+	const char *names[4] = { "fast vec3 linear @15Hz","fast vec3 linear @30Hz","fast vec3 linear @60Hz","fast vec3 linear @120Hz" };
+	VectorTrack track;
+	fillBenchmarkTrack( track,keys,30.0f,Interpolation::Linear );
+	std::vector<float> times = benchmarkSampleTimes( samples,float( keys - 1 ) / 30.0f );
+	printBenchmark( benchmarkTrack( "vec3 linear (binary search)",track,times ),"samples" );
+	for ( int r = 0; r < 4; ++r )
+	{
+		FastVectorTrack fast( track,rates[r] );
+		BenchmarkResult result = runBenchmark( names[r],double( times.size() ),[&]()
+		{
+			float acc = 0.0f;
+			for ( size_t i = 0; i < times.size(); ++i )
+			{
+				acc += fast.Sample( times[i],true ).x;
+			}
+			benchmarkSink() = acc;
+		} );
+		printBenchmark( result,"samples" );
+		std::cout << "  lookup table: " << fast.GetLookupTableBytes() << " bytes\n";
+	}
+}
+
+// Forward playback at a fixed step: fresh binary search every sample against
+// a cursor that remembers the previous key.
+inline void benchmarkCursorSampling( unsigned int keys = 1800,unsigned int samples = 1000000,float dt = 1.0f / 60.0f )
+{
+	VectorTrack track;
+	fillBenchmarkTrack( track,keys,30.0f,Interpolation::Linear );
+	printBenchmark( runBenchmark( "vec3 linear forward (binary search)",double( samples ),[&]()
+	{
+		float acc = 0.0f;
+		for ( unsigned int i = 0; i < samples; ++i )
+		{
+			acc += track.Sample( float( i ) * dt,true ).x;
+		}
+		benchmarkSink() = acc;
+	} ),"samples" );
+	printBenchmark( runBenchmark( "vec3 linear forward (cursor)",double( samples ),[&]()
+	{
+		TrackCursor cursor;
+		float acc = 0.0f;
+		for ( unsigned int i = 0; i < samples; ++i )
+		{
+			acc += cursor.Sample( track,float( i ) * dt,true ).x;
+		}
+		benchmarkSink() = acc;
+	} ),"samples" );
+}
+
+// Key lookup alone (no interpolation): plain binary search over the frames
+// against the SIMD scan (short tracks) and the Eytzinger index (long tracks).
+inline void benchmarkKeySearch( unsigned int samples = 2000000 )
+{
+	const unsigned int lengths[6] = { 16,32,64,10000,100000,1000000 };
+	for ( int l = 0; l < 6; ++l )
+	{
+		ScalarTrack track;
+		fillBenchmarkTrack( track,lengths[l],30.0f,Interpolation::Linear );
+		std::vector<float> times = benchmarkSampleTimes( samples,float( lengths[l] - 1 ) / 30.0f / 1.5f );
+		KeyTimeIndex index;
+		index.Build( track );
+		std::cout << lengths[l] << " keys, " << (index.IsEytzinger() ? "eytzinger" : "simd scan")
+			<< " index " << index.GetIndexBytes() << " bytes\n";
+		printBenchmark( runBenchmark( "  binary search",double( samples ),[&]()
+		{
+			int acc = 0;
+			for ( size_t i = 0; i < times.size(); ++i )
+			{
+				acc += track.FrameIndex( times[i] );
+			}
+			benchmarkSink() = float( acc );
+		} ),"lookups" );
+		printBenchmark( runBenchmark( "  key time index",double( samples ),[&]()
+		{
+			int acc = 0;
+			for ( size_t i = 0; i < times.size(); ++i )
+			{
+				acc += index.FrameIndex( times[i] );
+			}
+			benchmarkSink() = float( acc );
+		} ),"lookups" );
+	}
+}
+
+// Track against its load time polynomial form, linear and cubic.
+inline void benchmarkPolynomialTrackSampling( unsigned int keys = 120,unsigned int samples = 1000000 )
+{
+	const char *names[2][4] = {
+		{ "vec3 linear","vec3 linear polynomial","quat linear","quat linear polynomial" },
+		{ "vec3 cubic","vec3 cubic polynomial","quat cubic","quat cubic polynomial" } };
+	const Interpolation modes[2] = { Interpolation::Linear,Interpolation::Cubic };
+	std::vector<float> times = benchmarkSampleTimes( samples,float( keys - 1 ) / 30.0f );
+	for ( int m = 0; m < 2; ++m )
+	{
+		VectorTrack v;
+		QuaternionTrack q;
+		fillBenchmarkTrack( v,keys,30.0f,modes[m] );
+		fillBenchmarkTrack( q,keys,30.0f,modes[m] );
+		printBenchmark( benchmarkTrack( names[m][0],v,times ),"samples" );
+		printBenchmark( benchmarkTrack( names[m][1],PolynomialVectorTrack( v ),times ),"samples" );
+		printBenchmark( benchmarkTrack( names[m][2],q,times ),"samples" );
+		printBenchmark( benchmarkTrack( names[m][3],PolynomialQuaternionTrack( q ),times ),"samples" );
+	}
+}
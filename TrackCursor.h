@@ -0,0 +1,73 @@
+#pragma once
+#include "Track.h"
+
+#define TRACK_CURSOR_MAX_WALK 4
+
+// Per-instance, per-track memory of the last key used. Forward playback
+// barely moves between frames, so the lookup walks a step or two from the
+// previous key instead of searching the whole track. Walks longer than
+// TRACK_CURSOR_MAX_WALK (seeks, loop wraps, large time steps) fall back to
+// the track's own FrameIndex. Works with Track, FastTrack or anything with
+// the same FrameIndex/SampleSegment interface; the clip itself stores nothing.
+class TrackCursor
+{
+	int mFrame;
+public:
+	TrackCursor() : mFrame( -1 ) {}
+	void Reset() { mFrame = -1; }
+	int GetFrame() const { return mFrame; }
+
+	// time must already be adjusted with AdjustTimeToFitTrack.
+	template<typename TrackT>
+	int FrameIndex( const TrackT &track,float time )
+	{
+		int last = (int)track.Size() - 2;
+		if ( last < 0 )
+		{
+			mFrame = -1;
+			return -1;
+		}
+		int frame = mFrame;
+		if ( frame >= 0 && frame <= last )
+		{
+			if ( track[frame].mTime <= time )
+			{
+				for ( int step = 0; step < TRACK_CURSOR_MAX_WALK; ++step )
+				{
+					if ( frame == last || track[frame + 1].mTime > time )
+					{
+						return mFrame = frame;
+					}
+					++frame;
+				}
+			}
+			else
+			{
+				for ( int step = 0; step < TRACK_CURSOR_MAX_WALK && frame > 0; ++step )
+				{
+					--frame;
+					if ( track[frame].mTime <= time )
+					{
+						return mFrame = frame;
+					}
+				}
+				if ( frame == 0 )
+				{
+					return mFrame = 0;
+				}
+			}
+		}
+		return mFrame = track.FrameIndex( time );
+	}
+
+	template<typename TrackT>
+	typename TrackT::value_type Sample( const TrackT &track,float time,bool looping )
+	{
+		if ( track.Size() == 0 )
+		{
+			return typename TrackT::value_type();
+		}
+		float t = track.AdjustTimeToFitTrack( time,looping );
+		return track.SampleSegment( FrameIndex( track,t ),t );
+	}
+};
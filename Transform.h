@@ -0,0 +1,226 @@
+#pragma once
+#include <vector>
+#include <math.h>
+#include "Vec3.h"
+#include "quat.h"
+#include "mat4.h"
+
+// Scale, rotation, translation. Applied to a point in that order; combine
+// composes parent and child without going through matrices.
+struct Transform
+{
+	vec3 position;
+	quat rotation;
+	vec3 scale;
+	Transform( const vec3 &p,const quat &r,const vec3 &s )
+		:
+		position( p ),
+		rotation( r ),
+		scale( s )
+	{};
+	Transform()
+		:
+		position( vec3( 0,0,0 ) ),
+		rotation( quat( 0,0,0,1 ) ),
+		scale( vec3( 1,1,1 ) )
+	{};
+};
+
+// Parent a, child b: applying the result equals applying b, then a.
+inline Transform combine( const Transform &a,const Transform &b )
+{
+	Transform out;
+	out.scale = a.scale * b.scale;
+	out.rotation = b.rotation * a.rotation;
+	out.position = a.position + a.rotation * (a.scale * b.position);
+	return out;
+}
+
+inline Transform inverse( const Transform &t )
+{
+	Transform inv;
+	inv.rotation = inverse( t.rotation );
+	inv.scale.x = fabsf( t.scale.x ) < VEC3_EPSILON ? 0.0f : 1.0f / t.scale.x;
+	inv.scale.y = fabsf( t.scale.y ) < VEC3_EPSILON ? 0.0f : 1.0f / t.scale.y;
+	inv.scale.z = fabsf( t.scale.z ) < VEC3_EPSILON ? 0.0f : 1.0f / t.scale.z;
+	inv.position = inv.rotation * (inv.scale * (t.position * -1.0f));
+	return inv;
+}
+
+inline Transform mix( const Transform &a,const Transform &b,float t )
+{
+	quat bRot = b.rotation;
+	if ( dot( a.rotation,bRot ) < 0.0f )
+	{
+		bRot = -bRot;
+	}
+	return Transform(
+		lerp( a.position,b.position,t ),
+		nlerp( a.rotation,bRot,t ),
+		lerp( a.scale,b.scale,t ) );
+}
+
+inline bool operator==( const Transform &a,const Transform &b )
+{
+	return a.position == b.position && a.rotation == b.rotation && a.scale == b.scale;
+}
+
+inline bool operator!=( const Transform &a,const Transform &b )
+{
+	return !(a == b);
+}
+
+inline Affine<mat4> transformToMat4( const Transform &t )
+{
+	return trs( t.position,t.rotation,t.scale );
+}
+
+// Scale is recovered from the rotation-free part of the upper 3 x 3, so
+// skew in the input is dropped.
+inline Transform mat4ToTransform( const mat4 &m )
+{
+	Transform out;
+	out.position = vec3( m.v[12],m.v[13],m.v[14] );
+	out.rotation = mat4ToQuat( m );
+	mat4 rotScale(
+		m.v[0],m.v[1],m.v[2],0,
+		m.v[4],m.v[5],m.v[6],0,
+		m.v[8],m.v[9],m.v[10],0,
+		0,0,0,1 );
+	mat4 scaleSkew = inverse( quatToMat4( out.rotation ) ).m * rotScale;
+	out.scale = vec3( scaleSkew.v[0],scaleSkew.v[5],scaleSkew.v[10] );
+	return out;
+}
+
+inline vec3 transformPoint( const Transform &a,const vec3 &b )
+{
+	return a.position + a.rotation * (a.scale * b);
+}
+
+inline vec3 transformVector( const Transform &a,const vec3 &b )
+{
+	return a.rotation * (a.scale * b);
+}
+
+// Structure of arrays version for whole skeletons: one float stream per
+// component, so the element-wise operations below run as plain loops the
+// compiler can vectorize.
+struct TransformSoA
+{
+	std::vector<float> px,py,pz;
+	std::vector<float> rx,ry,rz,rw;
+	std::vector<float> sx,sy,sz;
+
+	unsigned int Size() const { return (unsigned int)px.size(); }
+	void Resize( unsigned int size )
+	{
+		px.resize( size ); py.resize( size ); pz.resize( size );
+		rx.resize( size ); ry.resize( size ); rz.resize( size ); rw.resize( size,1.0f );
+		sx.resize( size,1.0f ); sy.resize( size,1.0f ); sz.resize( size,1.0f );
+	}
+	Transform Get( unsigned int i ) const
+	{
+		return Transform(
+			vec3( px[i],py[i],pz[i] ),
+			quat( rx[i],ry[i],rz[i],rw[i] ),
+			vec3( sx[i],sy[i],sz[i] ) );
+	}
+	void Set( unsigned int i,const Transform &t )
+	{
+		px[i] = t.position.x; py[i] = t.position.y; pz[i] = t.position.z;
+		rx[i] = t.rotation.x; ry[i] = t.rotation.y; rz[i] = t.rotation.z; rw[i] = t.rotation.w;
+		sx[i] = t.scale.x; sy[i] = t.scale.y; sz[i] = t.scale.z;
+	}
+	void Load( const Transform *transforms,unsigned int count )
+	{
+		Resize( count );
+		for ( unsigned int i = 0; i < count; ++i )
+		{
+			Set( i,transforms[i] );
+		}
+	}
+	void Store( Transform *transforms ) const
+	{
+		for ( unsigned int i = 0, size = Size(); i < size; ++i )
+		{
+			transforms[i] = Get( i );
+		}
+	}
+};
+
+// out[i] = combine( a[i], b[i] ). out may alias a or b.
+inline void combine( const TransformSoA &a,const TransformSoA &b,TransformSoA &out )
+{
+	unsigned int size = a.Size();
+	out.Resize( size );
+	for ( unsigned int i = 0; i < size; ++i )
+	{
+		float ax = a.rx[i], ay = a.ry[i], az = a.rz[i], aw = a.rw[i];
+		float bx = b.rx[i], by = b.ry[i], bz = b.rz[i], bw = b.rw[i];
+		// child position, scaled by the parent then rotated: v + 2w(q x v) + 2 q x (q x v)
+		float vx = a.sx[i] * b.px[i], vy = a.sy[i] * b.py[i], vz = a.sz[i] * b.pz[i];
+		float tx = 2.0f * (ay * vz - az * vy);
+		float ty = 2.0f * (az * vx - ax * vz);
+		float tz = 2.0f * (ax * vy - ay * vx);
+		out.px[i] = a.px[i] + vx + aw * tx + (ay * tz - az * ty);
+		out.py[i] = a.py[i] + vy + aw * ty + (az * tx - ax * tz);
+		out.pz[i] = a.pz[i] + vz + aw * tz + (ax * ty - ay * tx);
+		// b.rotation * a.rotation in quat.h's order
+		out.rx[i] = aw * bx + bw * ax + (ay * bz - az * by);
+		out.ry[i] = aw * by + bw * ay + (az * bx - ax * bz);
+		out.rz[i] = aw * bz + bw * az + (ax * by - ay * bx);
+		out.rw[i] = aw * bw - (ax * bx + ay * by + az * bz);
+		out.sx[i] = a.sx[i] * b.sx[i];
+		out.sy[i] = a.sy[i] * b.sy[i];
+		out.sz[i] = a.sz[i] * b.sz[i];
+	}
+}
+
+inline void inverse( const TransformSoA &in,TransformSoA &out )
+{
+	unsigned int size = in.Size();
+	out.Resize( size );
+	for ( unsigned int i = 0; i < size; ++i )
+	{
+		float lenSq = in.rx[i] * in.rx[i] + in.ry[i] * in.ry[i] + in.rz[i] * in.rz[i] + in.rw[i] * in.rw[i];
+		float recip = lenSq < QUAT_EPSILON ? 0.0f : 1.0f / lenSq;
+		float qx = -in.rx[i] * recip, qy = -in.ry[i] * recip, qz = -in.rz[i] * recip, qw = in.rw[i] * recip;
+		float isx = fabsf( in.sx[i] ) < VEC3_EPSILON ? 0.0f : 1.0f / in.sx[i];
+		float isy = fabsf( in.sy[i] ) < VEC3_EPSILON ? 0.0f : 1.0f / in.sy[i];
+		float isz = fabsf( in.sz[i] ) < VEC3_EPSILON ? 0.0f : 1.0f / in.sz[i];
+		float vx = -in.px[i] * isx, vy = -in.py[i] * isy, vz = -in.pz[i] * isz;
+		float tx = 2.0f * (qy * vz - qz * vy);
+		float ty = 2.0f * (qz * vx - qx * vz);
+		float tz = 2.0f * (qx * vy - qy * vx);
+		out.px[i] = vx + qw * tx + (qy * tz - qz * ty);
+		out.py[i] = vy + qw * ty + (qz * tx - qx * tz);
+		out.pz[i] = vz + qw * tz + (qx * ty - qy * tx);
+		out.rx[i] = qx; out.ry[i] = qy; out.rz[i] = qz; out.rw[i] = qw;
+		out.sx[i] = isx; out.sy[i] = isy; out.sz[i] = isz;
+	}
+}
+
+inline void mix( const TransformSoA &a,const TransformSoA &b,float t,TransformSoA &out )
+{
+	unsigned int size = a.Size();
+	out.Resize( size );
+	float s = 1.0f - t;
+	for ( unsigned int i = 0; i < size; ++i )
+	{
+		float d = a.rx[i] * b.rx[i] + a.ry[i] * b.ry[i] + a.rz[i] * b.rz[i] + a.rw[i] * b.rw[i];
+		float bt = d < 0.0f ? -t : t;
+		float qx = a.rx[i] * s + b.rx[i] * bt;
+		float qy = a.ry[i] * s + b.ry[i] * bt;
+		float qz = a.rz[i] * s + b.rz[i] * bt;
+		float qw = a.rw[i] * s + b.rw[i] * bt;
+		float lenSq = qx * qx + qy * qy + qz * qz + qw * qw;
+		float n = lenSq < QUAT_EPSILON ? 0.0f : 1.0f / sqrtf( lenSq );
+		out.rx[i] = qx * n; out.ry[i] = qy * n; out.rz[i] = qz * n; out.rw[i] = qw * n;
+		out.px[i] = a.px[i] + (b.px[i] - a.px[i]) * t;
+		out.py[i] = a.py[i] + (b.py[i] - a.py[i]) * t;
+		out.pz[i] = a.pz[i] + (b.pz[i] - a.pz[i]) * t;
+		out.sx[i] = a.sx[i] + (b.sx[i] - a.sx[i]) * t;
+		out.sy[i] = a.sy[i] + (b.sy[i] - a.sy[i]) * t;
+		out.sz[i] = a.sz[i] + (b.sz[i] - a.sz[i]) * t;
+	}
+}
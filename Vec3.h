@@ -1,117 +1,75 @@
 #pragma once
-#include <math.h>
+#include "TVec.h"
+#include "VecExpr.h"
 
 #define VEC3_EPSILON 0.000001f
 
-struct vec3
-{
-	union
-	{
-		struct
-		{
-			float x;
-			float y;
-			float z;
-		};
-		float v[3];
-	};
-	vec3() : x( .0f ),y( .0f ),z( .0f ) {};
-	vec3( float x_in,float y_in,float z_in ) : x( x_in ),y( y_in ),z( z_in ) {};
-	vec3( float fv[3] ) : x( fv[0] ),y( fv[1] ),z( fv[2] ) {};
-	vec3( const vec3& rhs ) : x( rhs.x ),y( rhs.y ),z( rhs.z ) {};
-	vec3& operator=( const vec3& v )
-	{
-		x = v.x;
-		y = v.y;
-		z = v.z;
-		return *this;
-	}
-};
-
-vec3 operator+( const vec3& lhs,const vec3& rhs )
-{
-	return vec3( lhs.x + rhs.x,lhs.y + rhs.y,lhs.z + rhs.z );
-}
-
-vec3 operator-( const vec3& lhs,const vec3& rhs )
-{
-	return vec3( lhs.x - rhs.x,lhs.y - rhs.y,lhs.z - rhs.z );
-}
+// Functions that need no sqrt or trigonometry are constexpr and read
+// components through v[], the active member in constant evaluation.
 
-vec3 operator*( const vec3& v,float n )
-{
-	return vec3( v.x * n,v.y * n,v.z * n );
-}
-
-vec3 operator*( const vec3& lhs,const vec3& rhs )
-{
-	return vec3( lhs.x * rhs.x,lhs.y * rhs.y,lhs.z * rhs.z );
-}
-
-float dot( const vec3& lhs,const vec3& rhs )
-{
-	return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
-}
+typedef TVec<float,3> vec3;
 
-float lengthSq( const vec3 &v )
+constexpr float lengthSq( const vec3 &v )
 {
-	float lenSq = v.x*v.x + v.y*v.y + v.z*v.z;
+	float lenSq = v.v[0]*v.v[0] + v.v[1]*v.v[1] + v.v[2]*v.v[2];
 	return (lenSq < VEC3_EPSILON) ? 0.0f : lenSq;
 }
 
-float length( const vec3 &v )
+inline float length( const vec3 &v )
 {
 	return sqrtf( lengthSq( v ) );
 }
 
-vec3 normalized( const vec3& v )
+inline vec3 normalized( const vec3& v )
 {
 	float len = length( v );
-	return ( len < VEC3_EPSILON) ? v * (1 / len) : v;
+	return ( len < VEC3_EPSILON ) ? v : v * (1 / len);
 }
 
-void normalize( vec3& v )
+inline void normalize( vec3& v )
 {
 	v = normalized( v );
 }
 
-float angle( const vec3& lhs,const vec3& rhs )
+inline float angle( const vec3& lhs,const vec3& rhs )
 {
 	float lenl = lengthSq( lhs );
 	float lenr = lengthSq( rhs );
-	return (lenl == 0.0f || lenr == 0.0f) ? 0.0f : acosf( sqrtf( lenl * lenr ) / dot( lhs,rhs ) );
+	return (lenl == 0.0f || lenr == 0.0f) ? 0.0f : acosf( dot( lhs,rhs ) / sqrtf( lenl * lenr ) );
 }
 
-vec3 project( const vec3& lhs,const vec3& rhs )
+constexpr vec3 project( const vec3& lhs,const vec3& rhs )
 {
-	return rhs * (dot( lhs,rhs ) / length( rhs ));
+	float lenSq = lengthSq( rhs );
+	return (lenSq == 0.0f) ? vec3() : rhs * (dot( lhs,rhs ) / lenSq);
 }
 
-vec3 reject( const vec3& lhs,const vec3& rhs )
+constexpr vec3 reject( const vec3& lhs,const vec3& rhs )
 {
 	return lhs - project( lhs,rhs );
 }
 
-vec3 reflect( const vec3& lhs,const vec3& rhs )
+constexpr vec3 reflect( const vec3& lhs,const vec3& rhs )
 {
 	return lhs - (project( lhs,rhs ) * 2);
 }
 
-vec3 cross( const vec3& lhs,const vec3& rhs )
+constexpr vec3 cross( const vec3& lhs,const vec3& rhs )
 {
 	return vec3(
-		lhs.y * rhs.z - lhs.z * rhs.y,
-		lhs.x * rhs.z - lhs.z * rhs.x,
-		lhs.x * rhs.y - lhs.y * rhs.x
+		lhs.v[1] * rhs.v[2] - lhs.v[2] * rhs.v[1],
+		lhs.v[2] * rhs.v[0] - lhs.v[0] * rhs.v[2],
+		lhs.v[0] * rhs.v[1] - lhs.v[1] * rhs.v[0]
 	);
 }
 
-vec3 lerp( const vec3& lhs,const vec3& rhs,float t )
+// One pass per component, no temporaries for the difference or the scaled term.
+constexpr vec3 lerp( const vec3& lhs,const vec3& rhs,float t )
 {
-	return lhs + (rhs - lhs) * t;
+	return eval( lazy( lhs ) + (lazy( rhs ) - lazy( lhs )) * t );
 }
 
-vec3 slerp( const vec3& lhs,const vec3& rhs,float t )
+inline vec3 slerp( const vec3& lhs,const vec3& rhs,float t )
 {
 	if ( t < 0.01f )
 	{
@@ -123,17 +81,17 @@ vec3 slerp( const vec3& lhs,const vec3& rhs,float t )
 		+ normalized( rhs ) * (sinf( t * theta ) / sin_theta);
 }
 
-vec3 nlerp( const vec3 &lhs,const vec3 &rhs,float t )
+inline vec3 nlerp( const vec3 &lhs,const vec3 &rhs,float t )
 {
 	return normalized( lerp( lhs,rhs,t ) );
 }
 
-bool operator==( const vec3 &lhs,const vec3 &rhs )
+constexpr bool operator==( const vec3 &lhs,const vec3 &rhs )
 {
 	return lengthSq( lhs - rhs ) < VEC3_EPSILON;
 }
 
-bool operator!=( const vec3 &lhs,const vec3 &rhs )
+constexpr bool operator!=( const vec3 &lhs,const vec3 &rhs )
 {
 	return !(lhs == rhs);
 }
\ No newline at end of file
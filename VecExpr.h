@@ -0,0 +1,208 @@
+#pragma once
+#include "TVec.h"
+
+// Opt-in expression templates for TVec arithmetic. Wrapping an operand with
+// lazy() makes the operators below build a tree instead of a temporary per
+// step; eval() (or conversion to TVec) then computes every component of the
+// whole chain in one pass. Each component goes through the same operations in
+// the same order as the scalar eager operators; results equal the eager ones
+// within rounding, since the float x 4 SSE dot sums in a different order.
+// Vec3.h lerp and quat.h's quat * vec3 are written this way.
+//
+// Leaves hold references: evaluate within the full expression that created
+// them, never keep an expression around in an auto variable.
+//
+//	vec3 r = lazy( a ) * 2.0f + lazy( b ) * t - cross( lazy( c ),lazy( d ) );
+
+// Writes components [0, I) of an expression, unrolled at compile time so the
+// per component code inlines flat and loops over many vectors still vectorize.
+template<int I>
+struct TVecExprStore
+{
+	template<typename E,typename T,int N>
+	static constexpr void apply( const E &e,TVec<T,N> &r )
+	{
+		TVecExprStore<I - 1>::apply( e,r );
+		r.v[I - 1] = e.at( I - 1 );
+	}
+};
+
+template<>
+struct TVecExprStore<0>
+{
+	template<typename E,typename T,int N>
+	static constexpr void apply( const E &,TVec<T,N> & ) {}
+};
+
+template<typename E,typename T,int N>
+struct TVecExpr
+{
+	typedef T value_type;
+	static const int size = N;
+	constexpr const E& self() const { return static_cast<const E&>(*this); }
+	constexpr TVec<T,N> eval() const
+	{
+		TVec<T,N> r;
+		TVecExprStore<N>::apply( self(),r );
+		return r;
+	}
+	constexpr operator TVec<T,N>() const { return eval(); }
+};
+
+template<typename T,int N>
+struct TVecRef : public TVecExpr<TVecRef<T,N>,T,N>
+{
+	const TVec<T,N> &ref;
+	constexpr explicit TVecRef( const TVec<T,N> &v ) : ref( v ) {};
+	constexpr T at( int i ) const { return ref.v[i]; }
+};
+
+struct TExprAdd
+{
+	template<typename T>
+	static constexpr T apply( T a,T b ) { return a + b; }
+};
+
+struct TExprSub
+{
+	template<typename T>
+	static constexpr T apply( T a,T b ) { return a - b; }
+};
+
+struct TExprMul
+{
+	template<typename T>
+	static constexpr T apply( T a,T b ) { return a * b; }
+};
+
+template<typename Op,typename L,typename R,typename T,int N>
+struct TVecBinary : public TVecExpr<TVecBinary<Op,L,R,T,N>,T,N>
+{
+	L l;
+	R r;
+	constexpr TVecBinary( const L &_l,const R &_r ) : l( _l ),r( _r ) {};
+	constexpr T at( int i ) const { return Op::apply( l.at( i ),r.at( i ) ); }
+};
+
+// Scalar on the right or the left: kept apart so a * s and s * a evaluate in
+// the same operand order as the eager operators.
+template<typename L,typename T,int N>
+struct TVecScaleR : public TVecExpr<TVecScaleR<L,T,N>,T,N>
+{
+	L l;
+	T s;
+	constexpr TVecScaleR( const L &_l,T _s ) : l( _l ),s( _s ) {};
+	constexpr T at( int i ) const { return l.at( i ) * s; }
+};
+
+template<typename L,typename T,int N>
+struct TVecScaleL : public TVecExpr<TVecScaleL<L,T,N>,T,N>
+{
+	L l;
+	T s;
+	constexpr TVecScaleL( T _s,const L &_l ) : l( _l ),s( _s ) {};
+	constexpr T at( int i ) const { return s * l.at( i ); }
+};
+
+template<typename L,typename T,int N>
+struct TVecNeg : public TVecExpr<TVecNeg<L,T,N>,T,N>
+{
+	L l;
+	constexpr explicit TVecNeg( const L &_l ) : l( _l ) {};
+	constexpr T at( int i ) const { return l.at( i ) * T( -1 ); }
+};
+
+template<typename L,typename R,typename T>
+struct TVecCross : public TVecExpr<TVecCross<L,R,T>,T,3>
+{
+	L l;
+	R r;
+	constexpr TVecCross( const L &_l,const R &_r ) : l( _l ),r( _r ) {};
+	constexpr T at( int i ) const
+	{
+		return l.at( (i + 1) % 3 ) * r.at( (i + 2) % 3 ) - l.at( (i + 2) % 3 ) * r.at( (i + 1) % 3 );
+	}
+};
+
+template<typename T,int N>
+constexpr TVecRef<T,N> lazy( const TVec<T,N> &v )
+{
+	return TVecRef<T,N>( v );
+}
+
+template<typename E,typename T,int N>
+constexpr TVec<T,N> eval( const TVecExpr<E,T,N> &e )
+{
+	return e.eval();
+}
+
+#define TVEC_EXPR_BINARY( op,Op ) \
+template<typename L,typename R,typename T,int N> \
+constexpr TVecBinary<Op,L,R,T,N> operator op( const TVecExpr<L,T,N> &l,const TVecExpr<R,T,N> &r ) \
+{ \
+	return TVecBinary<Op,L,R,T,N>( l.self(),r.self() ); \
+} \
+template<typename L,typename T,int N> \
+constexpr TVecBinary<Op,L,TVecRef<T,N>,T,N> operator op( const TVecExpr<L,T,N> &l,const TVec<T,N> &r ) \
+{ \
+	return TVecBinary<Op,L,TVecRef<T,N>,T,N>( l.self(),TVecRef<T,N>( r ) ); \
+} \
+template<typename R,typename T,int N> \
+constexpr TVecBinary<Op,TVecRef<T,N>,R,T,N> operator op( const TVec<T,N> &l,const TVecExpr<R,T,N> &r ) \
+{ \
+	return TVecBinary<Op,TVecRef<T,N>,R,T,N>( TVecRef<T,N>( l ),r.self() ); \
+}
+
+TVEC_EXPR_BINARY( +,TExprAdd )
+TVEC_EXPR_BINARY( -,TExprSub )
+TVEC_EXPR_BINARY( *,TExprMul )
+
+#undef TVEC_EXPR_BINARY
+
+template<typename L,typename T,int N,typename S,typename = typename TScalarOperand<S,T>::type>
+constexpr TVecScaleR<L,T,N> operator*( const TVecExpr<L,T,N> &l,S s )
+{
+	return TVecScaleR<L,T,N>( l.self(),T( s ) );
+}
+
+template<typename L,typename T,int N,typename S,typename = typename TScalarOperand<S,T>::type>
+constexpr TVecScaleL<L,T,N> operator*( S s,const TVecExpr<L,T,N> &l )
+{
+	return TVecScaleL<L,T,N>( T( s ),l.self() );
+}
+
+template<typename L,typename T,int N>
+constexpr TVecNeg<L,T,N> operator-( const TVecExpr<L,T,N> &l )
+{
+	return TVecNeg<L,T,N>( l.self() );
+}
+
+// Reductions end the lazy chain and return a scalar.
+template<typename L,typename R,typename T,int N>
+constexpr T dot( const TVecExpr<L,T,N> &l,const TVecExpr<R,T,N> &r )
+{
+	T sum = l.self().at( 0 ) * r.self().at( 0 );
+	for ( int i = 1; i < N; ++i )
+	{
+		sum += l.self().at( i ) * r.self().at( i );
+	}
+	return sum;
+}
+
+template<typename L,typename T,int N>
+constexpr T dot( const TVecExpr<L,T,N> &l,const TVec<T,N> &r )
+{
+	return dot( l,lazy( r ) );
+}
+
+template<typename R,typename T,int N>
+constexpr T dot( const TVec<T,N> &l,const TVecExpr<R,T,N> &r )
+{
+	return dot( lazy( l ),r );
+}
+
+template<typename L,typename R,typename T>
+constexpr TVecCross<L,R,T> cross( const TVecExpr<L,T,3> &l,const TVecExpr<R,T,3> &r )
+{
+	return TVecCross<L,R,T>( l.self(),r.self() );
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "mat4.h"
+
+// Affine matrix with the implied (0,0,0,1) bottom row dropped, stored as
+// three rows of (m0, m1, m2, translation). Each row is one RGBA texel or
+// one SIMD register, which makes this the palette format for skinning and
+// texture upload. Row-major, unlike mat4.
+struct mat3x4
+{
+	float v[12];
+	constexpr mat3x4()
+		:
+		v{ 1,0,0,0,
+		0,1,0,0,
+		0,0,1,0 }
+	{};
+	constexpr explicit mat3x4( const mat4 &m )
+		:
+		v{ m.v[0],m.v[4],m.v[8],m.v[12],
+		m.v[1],m.v[5],m.v[9],m.v[13],
+		m.v[2],m.v[6],m.v[10],m.v[14] }
+	{};
+	constexpr const float* row( int r ) const { return v + r * 4; }
+};
+
+constexpr mat4 toMat4( const mat3x4 &m )
+{
+	return mat4(
+		m.v[0],m.v[4],m.v[8],0,
+		m.v[1],m.v[5],m.v[9],0,
+		m.v[2],m.v[6],m.v[10],0,
+		m.v[3],m.v[7],m.v[11],1 );
+}
+
+constexpr mat3x4 operator*( const mat3x4 &a,const mat3x4 &b )
+{
+	mat3x4 r;
+	for ( int row = 0; row < 3; ++row )
+	{
+		const float *ar = a.v + row * 4;
+		for ( int c = 0; c < 4; ++c )
+		{
+			r.v[row * 4 + c] = ar[0] * b.v[c] + ar[1] * b.v[4 + c] + ar[2] * b.v[8 + c];
+		}
+		r.v[row * 4 + 3] += ar[3];
+	}
+	return r;
+}
+
+constexpr vec3 transformPoint( const mat3x4 &m,const vec3 &p )
+{
+	return vec3(
+		m.v[0] * p.v[0] + m.v[1] * p.v[1] + m.v[2] * p.v[2] + m.v[3],
+		m.v[4] * p.v[0] + m.v[5] * p.v[1] + m.v[6] * p.v[2] + m.v[7],
+		m.v[8] * p.v[0] + m.v[9] * p.v[1] + m.v[10] * p.v[2] + m.v[11] );
+}
+
+constexpr vec3 transformVector( const mat3x4 &m,const vec3 &p )
+{
+	return vec3(
+		m.v[0] * p.v[0] + m.v[1] * p.v[1] + m.v[2] * p.v[2],
+		m.v[4] * p.v[0] + m.v[5] * p.v[1] + m.v[6] * p.v[2],
+		m.v[8] * p.v[0] + m.v[9] * p.v[1] + m.v[10] * p.v[2] );
+}
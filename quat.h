@@ -20,44 +20,41 @@ struct quat
 		};
 		float v[4];
 	};
-	inline quat()
+	constexpr quat()
 		:
-		vector(),
-		scalar( 0 )
+		v{ 0,0,0,0 }
 	{};
-	inline quat( float inx,float iny,float inz,float inw )
+	constexpr quat( float inx,float iny,float inz,float inw )
 		:
-		x( inx ),
-		y( iny ),
-		z( inz ),
-		w( inw )
+		v{ inx,iny,inz,inw }
 	{};
-	inline quat( vec3 inv,float ins )
+	constexpr quat( vec3 inv,float ins )
 		:
-		vector( inv ),
-		scalar( ins )
-	{};
-	inline quat( const quat& q )
-		:
-		vector( q.vector ),
-		scalar( q.scalar )
+		v{ inv.v[0],inv.v[1],inv.v[2],ins }
 	{};
 };
 
-quat angleAxis( float angle,const vec3 &axis )
+// As with vec3 and mat4, v[] is the storage constexpr code works on;
+// vector/scalar and x/y/z/w are runtime views of it.
+constexpr vec3 vectorPart( const quat &q )
+{
+	return vec3( q.v[0],q.v[1],q.v[2] );
+}
+
+inline quat angleAxis( float angle,const vec3 &axis )
 {
 	float s = sinf( angle * 0.5f );
 	vec3 vec = normalized( axis ) * s;
 	return { vec.x,vec.y,vec.z,cosf( angle * 0.5f ) };
 }
 
-quat fromTo( const vec3 &from,const vec3 &to )
+inline quat fromTo( const vec3 &from,const vec3 &to )
 {
 	vec3 f = normalized( from );
 	vec3 t = normalized( to );
 	if ( f == t )
 	{
-		return quat();
+		return quat( 0,0,0,1 );
 	}
 	else if ( f == t * (-1.0f) )
 	{
@@ -77,47 +74,48 @@ quat fromTo( const vec3 &from,const vec3 &to )
 	return quat( cross( f,half ),dot( f,half ) );
 }
 
-vec3 getAxis( const quat &q )
+inline vec3 getAxis( const quat &q )
 {
 	return normalized( q.vector );
 }
 
-float getAngle( const quat &q )
+inline float getAngle( const quat &q )
 {
 	return 2.0f * acosf( q.scalar );
 }
 
-quat operator+( const quat &a,const quat &b )
+constexpr quat operator+( const quat &a,const quat &b )
 {
-	return quat( a.vector + b.vector,a.scalar + b.scalar );
+	return quat( vectorPart( a ) + vectorPart( b ),a.v[3] + b.v[3] );
 }
 
-quat operator-( const quat &a,const quat &b )
+constexpr quat operator-( const quat &a,const quat &b )
 {
-	return quat( a.vector - b.vector,a.scalar - b.scalar );
+	return quat( vectorPart( a ) - vectorPart( b ),a.v[3] - b.v[3] );
 }
 
-quat operator*( const quat &q,float f )
+constexpr quat operator*( const quat &q,float f )
 {
-	return quat( q.vector * f,q.scalar * f );
+	return quat( vectorPart( q ) * f,q.v[3] * f );
 }
 
-quat operator-( const quat& q )
+constexpr quat operator-( const quat& q )
 {
 	return q * (-1.0f);
 }
 
-bool operator==( const quat &lhs,const quat &rhs )
+constexpr bool operator==( const quat &lhs,const quat &rhs )
 {
-	return (lhs.vector == rhs.vector && fabsf( lhs.scalar - rhs.scalar ) <= QUAT_EPSILON);
+	return (vectorPart( lhs ) == vectorPart( rhs ) &&
+		lhs.v[3] - rhs.v[3] <= QUAT_EPSILON && rhs.v[3] - lhs.v[3] <= QUAT_EPSILON);
 }
 
-bool operator!=( const quat &lhs,const quat &rhs ) 
+constexpr bool operator!=( const quat &lhs,const quat &rhs ) 
 {
 	return !(lhs == rhs);
 }
 
-bool sameOrientation( const quat &lhs,const quat &rhs )
+inline bool sameOrientation( const quat &lhs,const quat &rhs )
 {
 	return (fabsf( lhs.x - rhs.x ) <= QUAT_EPSILON  &&
 		fabsf( lhs.y - rhs.y ) <= QUAT_EPSILON  &&
@@ -129,43 +127,43 @@ bool sameOrientation( const quat &lhs,const quat &rhs )
 			fabsf( lhs.w + rhs.w ) <= QUAT_EPSILON);
 }
 
-float dot( const quat &lhs,const quat &rhs )
+constexpr float dot( const quat &lhs,const quat &rhs )
 {
-	return dot( lhs.vector,rhs.vector ) + lhs.scalar*rhs.scalar;
+	return dot( vectorPart( lhs ),vectorPart( rhs ) ) + lhs.v[3]*rhs.v[3];
 }
 
-float lenSq( const quat &q )
+constexpr float lenSq( const quat &q )
 {
 	return dot( q,q );
 }
 
-float len( const quat &q )
+inline float len( const quat &q )
 {
 	float lensq = lenSq( q );
 	return ( lensq < QUAT_EPSILON ) ? 0.0f : sqrtf( lensq );
 }
 
-quat normalized( const quat& q )
+inline quat normalized( const quat& q )
 {
 	float l = lenSq( q );
 	return ( l < QUAT_EPSILON ) ? quat() : q * (1.0f / sqrtf(l));
 }
 
-void normalize( quat& q )
+inline void normalize( quat& q )
 {
 	float l = lenSq( q );
 	if ( l < QUAT_EPSILON ) return;
 	float normalizer = 1 / sqrtf( l );
 	q.vector = q.vector * normalizer;
-	q.scalar /= normalizer;
+	q.scalar *= normalizer;
 }
 
-quat conjugate( const quat& q )
+constexpr quat conjugate( const quat& q )
 {
-	return -q;
+	return quat( -vectorPart( q ),q.v[3] );
 }
 
-quat inverse( const quat &q )
+constexpr quat inverse( const quat &q )
 {
 	float lensq = lenSq( q );
 	if ( lensq < QUAT_EPSILON )
@@ -173,35 +171,39 @@ quat inverse( const quat &q )
 		return quat();
 	}
 	float recip = 1.0f / lensq;
-	return quat( q.vector * (-recip),q.scalar * recip );
+	return quat( vectorPart( q ) * (-recip),q.v[3] * recip );
 }
 
-quat operator*( const quat &lhs,const quat &rhs )
+constexpr quat operator*( const quat &lhs,const quat &rhs )
 {
-	quat result;
-	result.scalar = rhs.scalar*lhs.scalar - dot( lhs.vector,rhs.vector );
-	result.vector = lhs.vector * rhs.scalar - rhs.vector * lhs.scalar + cross( rhs.vector,lhs.vector );
-	return result;
+	const vec3 lv = vectorPart( lhs );
+	const vec3 rv = vectorPart( rhs );
+	return quat(
+		lv * rhs.v[3] + rv * lhs.v[3] + cross( rv,lv ),
+		rhs.v[3]*lhs.v[3] - dot( lv,rv ) );
 }
 
-vec3 operator*( const quat &q,const vec3 &v )
+constexpr vec3 operator*( const quat &q,const vec3 &v )
 {
-	return q.vector * 2.0f * dot( q.vector,v ) +
-		v * (q.scalar * q.scalar - dot( q.vector,q.vector )) +
-		cross( q.vector,v ) * 2.0f * q.scalar;
+	const vec3 qv = vectorPart( q );
+	const float qs = q.v[3];
+	// Fused: the three terms are summed per component without temporaries.
+	return eval( lazy( qv ) * 2.0f * dot( qv,v ) +
+		lazy( v ) * (qs * qs - dot( qv,qv )) +
+		cross( lazy( qv ),lazy( v ) ) * 2.0f * qs );
 }
 
-quat mix( const quat &from,const quat &to,float t )
+constexpr quat mix( const quat &from,const quat &to,float t )
 {
 	return from * (1.0f - t) + to * t;
 }
 
-quat nlerp( const quat &from,const quat &to,float t )
+inline quat nlerp( const quat &from,const quat &to,float t )
 {
 	return normalized( from + (to - from)*t );
 }
 
-quat operator^( const quat &q,float f )
+inline quat operator^( const quat &q,float f )
 {
 	float halfAnglePowd = f * 0.5f * getAngle(q);
 	vec3 axis = getAxis( q );
@@ -210,7 +212,31 @@ quat operator^( const quat &q,float f )
 	return quat( axis * halfSin,halfCos );
 }
 
-quat slerp( const quat &start,const quat &end,float t )
+// Logarithm of a unit quaternion: axis * half angle. Take the w >= 0 member
+// of the pair for the short arc.
+inline vec3 quatLog( const quat &q )
+{
+	vec3 v = vectorPart( q );
+	float s = sqrtf( dot( v,v ) );
+	if ( s < QUAT_EPSILON )
+	{
+		return v;
+	}
+	float w = q.v[3] < -1.0f ? -1.0f : (q.v[3] > 1.0f ? 1.0f : q.v[3]);
+	return v * (acosf( w ) / s);
+}
+
+inline quat quatExp( const vec3 &v )
+{
+	float halfAngle = sqrtf( dot( v,v ) );
+	if ( halfAngle < QUAT_EPSILON )
+	{
+		return normalized( quat( v,1.0f ) );
+	}
+	return quat( v * (sinf( halfAngle ) / halfAngle),cosf( halfAngle ) );
+}
+
+inline quat slerp( const quat &start,const quat &end,float t )
 {
 	if ( fabsf( dot( start,end ) ) > 1.0f - QUAT_EPSILON )
 	{
@@ -220,3 +246,57 @@ quat slerp( const quat &start,const quat &end,float t )
 	return normalized( (delta ^ t) * start );
 }
 
+constexpr Rotation<mat4> quatToMat4( const quat &q )
+{
+	const vec3 r = q * vec3( 1,0,0 );
+	const vec3 u = q * vec3( 0,1,0 );
+	const vec3 f = q * vec3( 0,0,1 );
+	return Rotation<mat4>( mat4(
+		r.v[0],r.v[1],r.v[2],0,
+		u.v[0],u.v[1],u.v[2],0,
+		f.v[0],f.v[1],f.v[2],0,
+		0,0,0,1
+	) );
+}
+
+// Translation * rotation * scale, the usual node transform.
+constexpr Affine<mat4> trs( const vec3 &t,const quat &q,const vec3 &s )
+{
+	const vec3 r = q * vec3( 1,0,0 ) * s.v[0];
+	const vec3 u = q * vec3( 0,1,0 ) * s.v[1];
+	const vec3 f = q * vec3( 0,0,1 ) * s.v[2];
+	return Affine<mat4>( mat4(
+		r.v[0],r.v[1],r.v[2],0,
+		u.v[0],u.v[1],u.v[2],0,
+		f.v[0],f.v[1],f.v[2],0,
+		t.v[0],t.v[1],t.v[2],1
+	) );
+}
+
+// Rotation part of an affine matrix. Columns are normalized first so scale
+// does not leak into the result; Shepperd's method picks the largest of
+// w, x, y, z to divide by.
+inline quat mat4ToQuat( const mat4 &m )
+{
+	vec3 r = normalized( vec3( m.v[0],m.v[1],m.v[2] ) );
+	vec3 u = normalized( vec3( m.v[4],m.v[5],m.v[6] ) );
+	vec3 f = normalized( vec3( m.v[8],m.v[9],m.v[10] ) );
+	float trace = r.x + u.y + f.z;
+	if ( trace > 0.0f )
+	{
+		float s = 0.5f / sqrtf( trace + 1.0f );
+		return quat( (u.z - f.y) * s,(f.x - r.z) * s,(r.y - u.x) * s,0.25f / s );
+	}
+	if ( r.x > u.y && r.x > f.z )
+	{
+		float s = 2.0f * sqrtf( 1.0f + r.x - u.y - f.z );
+		return quat( 0.25f * s,(u.x + r.y) / s,(f.x + r.z) / s,(u.z - f.y) / s );
+	}
+	if ( u.y > f.z )
+	{
+		float s = 2.0f * sqrtf( 1.0f + u.y - r.x - f.z );
+		return quat( (u.x + r.y) / s,0.25f * s,(f.y + u.z) / s,(f.x - r.z) / s );
+	}
+	float s = 2.0f * sqrtf( 1.0f + f.z - r.x - u.y );
+	return quat( (f.x + r.z) / s,(f.y + u.z) / s,0.25f * s,(r.y - u.x) / s );
+}
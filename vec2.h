@@ -1,21 +1,8 @@
 #pragma once
+#include "TVec.h"
 
 template <typename T>
-struct TVec2
-{
-	union
-	{
-		struct
-		{
-			T x;
-			T y;
-		};
-		T v[2];
-	};
-	inline TVec2() : x( T( 0 ) ),y( T( 0 ) ) {};
-	inline TVec2( T _x,T _y ) : x( _x ),y( _y ) {};
-	inline TVec2( T* fv ) : x( fv[0] ),y( fv[1] ) {};
-};
+using TVec2 = TVec<T,2>;
 
 typedef TVec2<float> vec2;
 typedef TVec2<int> ivec2;